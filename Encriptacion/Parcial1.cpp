@@ -2,67 +2,931 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/stat.h>
+#include "../compresion/codec/cifrado.h"
 
-#define BUFFER_SIZE 1024
-#define XOR_KEY 0x5A  // Clave para encriptación y desencriptación
+using namespace codec;
 
-void encrypt_decrypt(const char *input_file) {
-    // Crear una copia temporal del archivo que se va a encriptar o desencriptar
-    std::string temp_file = "archivo_encriptar_desencriptar.txt";
-    std::string command_cp = "cp " + std::string(input_file) + " " + temp_file;
-    system(command_cp.c_str());
+// io_uring se usa con las llamadas al sistema directas: alcanza con los encabezados del kernel
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
 
-    // crear un archivo temporal de salida para que sea movido al archivo original
-    std::string processed_file = "archivo_encriptado_desencriptado.txt";
+#define DEFAULT_BUFFER_KB 1024  // Buffer de lectura/escritura por defecto (1 MB)
+#define MIN_BUFFER_KB 64
+#define MAX_BUFFER_KB (1024 * 1024)
+#define RANGE_SPLIT_MB 32  // Los archivos más grandes se reparten entre hilos en tramos de este tamaño
+#define MAX_JOBS 256
+#define IO_DEPTH 4  // Buffers en vuelo por hilo con io_uring
 
-    int fd_in = open(temp_file.c_str(), O_RDONLY);
-    if (fd_in < 0) {
-        perror("Error al abrir el archivo de entrada");
+// pwrite() puede escribir menos de lo pedido: se repite hasta completar el buffer
+static bool pwrite_all(int fd, const unsigned char *data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// pread() que repite hasta completar 'size' o llegar al final del archivo; -1 con errno si falla
+static ssize_t pread_full(int fd, unsigned char *data, size_t size, off_t offset) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread(fd, data + total, size - total, offset + static_cast<off_t>(total));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+// Backends de E/S para transformar un tramo:
+//  - IO_SYNC: leer, cifrar y escribir de a un buffer, todo en el hilo de trabajo.
+//  - IO_THREADS: doble buffer; un hilo auxiliar lee el bloque siguiente mientras el de trabajo
+//    cifra y escribe el actual.
+//  - IO_URING: IO_DEPTH buffers en vuelo con io_uring; mientras el kernel lee y escribe unos,
+//    el hilo cifra los que ya llegaron.
+enum io_backend { IO_SYNC, IO_THREADS, IO_URING };
+
+static const char *io_backend_name(io_backend backend) {
+    return backend == IO_URING ? "uring" : backend == IO_THREADS ? "hilos" : "sincronico";
+}
+
+// Hilo que lee por adelantado: recibe un pedido de lectura y lo atiende mientras el hilo de
+// trabajo hace otra cosa; finish() espera el resultado
+class read_ahead {
+public:
+    read_ahead() : has_request(false), has_result(false), stop(false), worker(&read_ahead::loop, this) {}
+
+    ~read_ahead() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+
+    void start(int fd, unsigned char *data, size_t size, off_t offset) {
+        std::lock_guard<std::mutex> lock(mutex);
+        request_fd = fd;
+        request_data = data;
+        request_size = size;
+        request_offset = offset;
+        has_request = true;
+        changed.notify_all();
+    }
+
+    // Bytes leídos (como pread_full), con errno del hilo auxiliar si falló
+    ssize_t finish() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!has_result) changed.wait(lock);
+        has_result = false;
+        errno = result_errno;
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool has_request, has_result, stop;
+    int request_fd;
+    unsigned char *request_data;
+    size_t request_size;
+    off_t request_offset;
+    ssize_t result;
+    int result_errno;
+    std::thread worker;  // Último: arranca con los demás miembros ya inicializados
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            while (!has_request && !stop) changed.wait(lock);
+            if (!has_request) return;
+            has_request = false;
+            lock.unlock();
+            ssize_t n = pread_full(request_fd, request_data, request_size, request_offset);
+            int error = errno;
+            lock.lock();
+            result = n;
+            result_errno = error;
+            has_result = true;
+            changed.notify_all();
+        }
+    }
+};
+
+#ifdef HAVE_IO_URING
+// Anillo de io_uring mínimo con las llamadas al sistema directas, sin depender de liburing
+struct uring {
+    int fd;
+    unsigned char *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    io_uring_sqe *sqes;
+    io_uring_cqe *cqes;
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    unsigned queued;  // Pedidos cargados que todavía no se enviaron al kernel
+};
+
+static void uring_exit(uring &r) {
+    if (r.sqes) munmap(r.sqes, r.sqes_size);
+    if (r.cq_ring && r.cq_ring != r.sq_ring) munmap(r.cq_ring, r.cq_ring_size);
+    if (r.sq_ring) munmap(r.sq_ring, r.sq_ring_size);
+    if (r.fd >= 0) close(r.fd);
+    r.fd = -1;
+}
+
+// false si el kernel no tiene io_uring, lo tiene deshabilitado (contenedores, seccomp) o es
+// anterior a 5.6 y no soporta IORING_OP_READ/WRITE
+static bool uring_init(uring &r, unsigned entries) {
+    memset(&r, 0, sizeof(r));
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    r.fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (r.fd < 0) return false;
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {  // Llegó en la misma versión que OP_READ/WRITE
+        uring_exit(r);
+        return false;
+    }
+    r.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) r.sq_ring_size = r.cq_ring_size = std::max(r.sq_ring_size, r.cq_ring_size);
+    void *sq = mmap(nullptr, r.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        uring_exit(r);
+        return false;
+    }
+    r.sq_ring = static_cast<unsigned char *>(sq);
+    void *cq = single_mmap ? sq : mmap(nullptr, r.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                       r.fd, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) {
+        uring_exit(r);
+        return false;
+    }
+    r.cq_ring = static_cast<unsigned char *>(cq);
+    r.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, r.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        uring_exit(r);
+        return false;
+    }
+    r.sqes = static_cast<io_uring_sqe *>(sqes);
+    r.sq_tail = reinterpret_cast<unsigned *>(r.sq_ring + params.sq_off.tail);
+    r.sq_mask = reinterpret_cast<unsigned *>(r.sq_ring + params.sq_off.ring_mask);
+    r.sq_array = reinterpret_cast<unsigned *>(r.sq_ring + params.sq_off.array);
+    r.cq_head = reinterpret_cast<unsigned *>(r.cq_ring + params.cq_off.head);
+    r.cq_tail = reinterpret_cast<unsigned *>(r.cq_ring + params.cq_off.tail);
+    r.cq_mask = reinterpret_cast<unsigned *>(r.cq_ring + params.cq_off.ring_mask);
+    r.cqes = reinterpret_cast<io_uring_cqe *>(r.cq_ring + params.cq_off.cqes);
+    return true;
+}
+
+// Carga un pedido de lectura o escritura; se envía en la próxima llamada a uring_wait
+static void uring_queue(uring &r, unsigned char op, int fd, unsigned char *data, size_t size, off_t offset,
+                        uint64_t user_data) {
+    unsigned tail = *r.sq_tail;
+    unsigned index = tail & *r.sq_mask;
+    io_uring_sqe *sqe = &r.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = op;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(size);
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = user_data;
+    r.sq_array[index] = index;
+    __atomic_store_n(r.sq_tail, tail + 1, __ATOMIC_RELEASE);  // El kernel ve el pedido completo
+    r.queued++;
+}
+
+// Envía los pedidos cargados y espera hasta que haya al menos una terminación
+static bool uring_wait(uring &r) {
+    for (;;) {
+        long n = syscall(__NR_io_uring_enter, r.fd, r.queued, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) continue;
+        if (n < 0) return false;
+        r.queued -= static_cast<unsigned>(n);
+        return true;
+    }
+}
+#endif
+
+// Recursos de E/S de un hilo de trabajo: los buffers y, según el backend, el hilo que lee por
+// adelantado o el anillo de io_uring. Si io_uring no está disponible se usa el doble buffer.
+struct io_engine {
+    io_backend backend;
+    size_t buffer_size;
+    std::vector<unsigned char> buffers;
+    std::unique_ptr<read_ahead> reader;
+#ifdef HAVE_IO_URING
+    uring ring;
+#endif
+
+    io_engine(io_backend requested, size_t size) : backend(requested), buffer_size(size) {
+#ifdef HAVE_IO_URING
+        ring.fd = -1;
+        if (backend == IO_URING && !uring_init(ring, 2 * IO_DEPTH)) backend = IO_THREADS;
+#else
+        if (backend == IO_URING) backend = IO_THREADS;
+#endif
+        size_t depth = backend == IO_URING ? IO_DEPTH : backend == IO_THREADS ? 2 : 1;
+        buffers.resize(depth * buffer_size);
+        if (backend == IO_THREADS) reader.reset(new read_ahead());
+    }
+
+    ~io_engine() {
+#ifdef HAVE_IO_URING
+        if (ring.fd >= 0) uring_exit(ring);
+#endif
+    }
+
+    unsigned char *buffer(size_t i) { return buffers.data() + i * buffer_size; }
+};
+
+// Para informar en -v qué backend se va a usar
+static io_backend probe_io_backend(io_backend requested) {
+    io_engine probe(requested, 0);
+    return probe.backend;
+}
+
+static bool transform_sync(io_engine &e, int fd_in, off_t in_base, int fd_out, off_t out_base, off_t offset,
+                           off_t length, const cipher &c) {
+    unsigned char *buffer = e.buffer(0);
+    while (length > 0) {
+        size_t wanted = static_cast<size_t>(std::min<off_t>(length, static_cast<off_t>(e.buffer_size)));
+        ssize_t bytes_read = pread(fd_in, buffer, wanted, in_base + offset);
+        if (bytes_read < 0 && errno == EINTR) continue;
+        if (bytes_read < 0) return false;
+        if (bytes_read == 0) {
+            errno = 0;  // El archivo se achicó mientras se procesaba
+            return false;
+        }
+        apply_cipher(c, buffer, static_cast<size_t>(bytes_read), static_cast<uint64_t>(offset));
+        if (!pwrite_all(fd_out, buffer, static_cast<size_t>(bytes_read), out_base + offset)) return false;
+        offset += bytes_read;
+        length -= bytes_read;
+    }
+    return true;
+}
+
+// Doble buffer: mientras se cifra y escribe un buffer, el hilo auxiliar llena el otro
+static bool transform_double_buffered(io_engine &e, int fd_in, off_t in_base, int fd_out, off_t out_base,
+                                      off_t offset, off_t length, const cipher &c) {
+    if (length == 0) return true;
+    off_t end = offset + length;
+    size_t current = 0;
+    size_t wanted = static_cast<size_t>(std::min<off_t>(length, static_cast<off_t>(e.buffer_size)));
+    e.reader->start(fd_in, e.buffer(current), wanted, in_base + offset);
+    for (;;) {
+        ssize_t bytes_read = e.reader->finish();
+        if (bytes_read < static_cast<ssize_t>(wanted)) {
+            if (bytes_read >= 0) errno = 0;  // El archivo se achicó mientras se procesaba
+            return false;
+        }
+        off_t next = offset + bytes_read;
+        size_t next_wanted = static_cast<size_t>(std::min<off_t>(end - next, static_cast<off_t>(e.buffer_size)));
+        if (next_wanted > 0) e.reader->start(fd_in, e.buffer(1 - current), next_wanted, in_base + next);
+
+        apply_cipher(c, e.buffer(current), wanted, static_cast<uint64_t>(offset));
+        bool written = pwrite_all(fd_out, e.buffer(current), wanted, out_base + offset);
+        if (!written || next_wanted == 0) {
+            if (next_wanted > 0) {
+                int error = errno;
+                e.reader->finish();  // No se puede soltar el buffer con una lectura en curso
+                errno = error;
+            }
+            return written;
+        }
+        offset = next;
+        wanted = next_wanted;
+        current = 1 - current;
+    }
+}
+
+#ifdef HAVE_IO_URING
+// Cada buffer pasa por leer -> cifrar -> escribir -> libre, con hasta IO_DEPTH buffers en vuelo.
+// Las lecturas y escrituras cortas se vuelven a pedir por lo que falta.
+static bool transform_uring(io_engine &e, int fd_in, off_t in_base, int fd_out, off_t out_base, off_t offset,
+                            off_t length, const cipher &c) {
+    struct slot {
+        off_t offset;
+        size_t size, done;
+        bool busy, writing;
+    } slots[IO_DEPTH];
+    for (size_t i = 0; i < IO_DEPTH; i++) slots[i].busy = false;
+
+    const off_t end = offset + length;
+    off_t next = offset;
+    unsigned in_flight = 0;
+    int error = -1;  // -1 sin error; 0 si el archivo se achicó; si no, el errno del pedido que falló
+    for (;;) {
+        for (size_t i = 0; i < IO_DEPTH && error < 0 && next < end; i++) {
+            if (slots[i].busy) continue;
+            size_t size = static_cast<size_t>(std::min<off_t>(end - next, static_cast<off_t>(e.buffer_size)));
+            slot s = {next, size, 0, true, false};
+            slots[i] = s;
+            uring_queue(e.ring, IORING_OP_READ, fd_in, e.buffer(i), size, in_base + next, i);
+            next += static_cast<off_t>(size);
+            in_flight++;
+        }
+        if (in_flight == 0) break;
+        if (!uring_wait(e.ring)) {
+            // Solo pasa con un anillo roto (EBADF, EFAULT): con pedidos en vuelo el kernel podría
+            // seguir escribiendo en los buffers, así que no hay forma segura de seguir
+            perror("Error en io_uring_enter");
+            abort();
+        }
+
+        unsigned head = *e.ring.cq_head;
+        unsigned tail = __atomic_load_n(e.ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe &cqe = e.ring.cqes[head & *e.ring.cq_mask];
+            slot &s = slots[cqe.user_data];
+            if (cqe.res <= 0 || error >= 0) {
+                // Ante un error se dejan terminar los pedidos en curso sin cargar más
+                if (error < 0) error = cqe.res < 0 ? -cqe.res : 0;
+                s.busy = false;
+                in_flight--;
+                continue;
+            }
+            s.done += static_cast<size_t>(cqe.res);
+            unsigned char *data = e.buffer(cqe.user_data);
+            if (s.done < s.size) {
+                uring_queue(e.ring, s.writing ? IORING_OP_WRITE : IORING_OP_READ, s.writing ? fd_out : fd_in,
+                            data + s.done, s.size - s.done, (s.writing ? out_base : in_base) + s.offset + s.done,
+                            cqe.user_data);
+            } else if (!s.writing) {
+                apply_cipher(c, data, s.size, static_cast<uint64_t>(s.offset));
+                s.writing = true;
+                s.done = 0;
+                uring_queue(e.ring, IORING_OP_WRITE, fd_out, data, s.size, out_base + s.offset, cqe.user_data);
+            } else {
+                s.busy = false;
+                in_flight--;
+            }
+        }
+        __atomic_store_n(e.ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+    errno = error > 0 ? error : 0;
+    return error < 0;
+}
+#endif
+
+// Cifra los datos [offset, offset + length) leyéndolos de fd_in en in_base + offset y escribiéndolos
+// en fd_out en out_base + offset (las bases saltean la cabecera del modo con clave; fd_out puede ser
+// el mismo descriptor). Con posiciones explícitas no se depende de la posición actual de los
+// descriptores, y varios hilos pueden trabajar sobre tramos distintos del mismo archivo.
+// Devuelve false con errno si falla la lectura o la escritura; quien llama informa el error.
+static bool transform_range(io_engine &e, int fd_in, off_t in_base, int fd_out, off_t out_base, off_t offset,
+                            off_t length, const cipher &c) {
+#ifdef HAVE_IO_URING
+    if (e.backend == IO_URING) return transform_uring(e, fd_in, in_base, fd_out, out_base, offset, length, c);
+#endif
+    if (e.backend == IO_THREADS) {
+        return transform_double_buffered(e, fd_in, in_base, fd_out, out_base, offset, length, c);
+    }
+    return transform_sync(e, fd_in, in_base, fd_out, out_base, offset, length, c);
+}
+
+// Directorio que contiene 'path' (el temporal tiene que estar en el mismo sistema de archivos)
+static std::string parent_dir(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return ".";
+    if (slash == 0) return "/";
+    return path.substr(0, slash);
+}
+
+// Crea el archivo temporal de salida junto al original. Con O_TMPFILE no tiene nombre hasta que
+// se confirma, así que si el programa muere no queda basura; si el sistema de archivos no lo
+// soporta se usa mkstemp con un nombre oculto y único. 'temp_path' queda vacío con O_TMPFILE.
+static int open_temp_beside(const std::string &target, std::string &temp_path) {
+    std::string dir = parent_dir(target);
+    temp_path.clear();
+    int fd;
+#ifdef O_TMPFILE
+    fd = open(dir.c_str(), O_TMPFILE | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (fd >= 0) return fd;
+#endif
+    size_t slash = target.find_last_of('/');
+    std::string base = slash == std::string::npos ? target : target.substr(slash + 1);
+    std::string pattern = dir + "/." + base + ".XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    fd = mkstemp(name.data());  // mkstemp ya crea el archivo con permisos 0600
+    if (fd >= 0) temp_path = name.data();
+    return fd;
+}
+
+// Da nombre al temporal y lo mueve sobre el original con rename(), que es atómico: quien abra
+// el archivo ve la versión vieja completa o la nueva completa, nunca una mezcla
+static bool commit_temp(int fd, std::string &temp_path, const std::string &target) {
+    if (temp_path.empty()) {
+        // Un temporal de O_TMPFILE se enlaza primero con un nombre único; linkat no puede reemplazar
+        std::string proc_path = "/proc/self/fd/" + std::to_string(fd);
+        for (int attempt = 0; temp_path.empty(); attempt++) {
+            std::string candidate = parent_dir(target) + "/.encriptador." + std::to_string(getpid()) + "." +
+                                    std::to_string(attempt);
+            if (linkat(AT_FDCWD, proc_path.c_str(), AT_FDCWD, candidate.c_str(), AT_SYMLINK_FOLLOW) == 0) {
+                temp_path = candidate;
+            } else if (errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    if (rename(temp_path.c_str(), target.c_str()) != 0) return false;
+    temp_path.clear();
+
+    // El rename queda en disco recién cuando se sincroniza el directorio
+    int dir_fd = open(parent_dir(target).c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return true;
+}
+
+// Un archivo del lote. Los archivos grandes se reparten en tramos entre los hilos: el primero que
+// toma un tramo abre el archivo y el temporal, y el que termina el último lo confirma y lo cierra.
+struct file_job {
+    std::string path;
+    off_t size;                       // Tamaño al recorrer los argumentos
+    off_t data_size;                  // Bytes a cifrar: sin la cabecera al desencriptar con clave
+    cipher c;                         // Con el nonce de este archivo en el modo con clave
+    int fd_in;
+    int fd_out;                       // Igual a fd_in en el modo en el lugar
+    std::string temp_path;
+    std::once_flag opened;
+    std::atomic<int> pending;         // Tramos que faltan terminar
+    std::atomic<bool> failed;
+    std::chrono::steady_clock::time_point start;
+
+    file_job(const std::string &p, off_t s, off_t d)
+        : path(p), size(s), data_size(d), c(), fd_in(-1), fd_out(-1), pending(0), failed(false) {}
+};
+
+struct range_job {
+    file_job *file;
+    off_t offset;
+    off_t length;
+};
+
+struct batch {
+    std::deque<file_job> files;       // deque: los file_job no se pueden mover
+    std::vector<range_job> ranges;    // En orden de archivo, así hay pocos archivos abiertos a la vez
+    std::atomic<size_t> next;
+    size_t buffer_size;
+    io_backend io;
+    bool in_place;
+    bool decrypt;
+    cipher base;                      // Kernels y clave; el nonce es de cada archivo
+    off_t in_base, out_base;          // Dónde empiezan los datos en la entrada y en la salida
+    std::mutex output;                // Los mensajes de distintos hilos no se mezclan
+    std::atomic<size_t> done;
+    std::atomic<size_t> failures;
+    std::atomic<unsigned long long> bytes;
+
+    batch()
+        : next(0), buffer_size(0), io(IO_SYNC), in_place(false), decrypt(false), base(), in_base(0), out_base(0), done(0),
+          failures(0), bytes(0) {}
+};
+
+static double elapsed_seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double to_mb(double bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+// Como perror, pero con el nombre del archivo y sin mezclarse con la salida de otros hilos
+static void report_error(batch &b, const char *what, const std::string &path) {
+    int error = errno;
+    std::lock_guard<std::mutex> lock(b.output);
+    std::cerr << what << " " << path;
+    if (error != 0) std::cerr << ": " << strerror(error);
+    std::cerr << "\n";
+}
+
+static void fail(batch &b, file_job &f, const char *what) {
+    if (!f.failed.exchange(true)) report_error(b, what, f.path);
+}
+
+// Lee la cabecera de un archivo encriptado con clave de 'size' bytes, completa el nonce de 'c' y
+// verifica la clave. HEADER_MISSING también cubre un error de lectura (con errno).
+static header_status read_keyed_header(int fd, off_t size, cipher &c) {
+    unsigned char stored[KEYED_HEADER_SIZE];
+    errno = 0;
+    if (size < KEYED_HEADER_SIZE || pread(fd, stored, sizeof(stored), 0) != KEYED_HEADER_SIZE) {
+        return HEADER_MISSING;
+    }
+    return check_keyed_header(stored, c);
+}
+
+// Prepara el cifrado del archivo: al encriptar elige un nonce nuevo y escribe la cabecera en la
+// salida; al desencriptar la lee de la entrada y verifica la clave
+static bool prepare_keyed(batch &b, file_job &f) {
+    unsigned char header[KEYED_HEADER_SIZE];
+    if (!b.decrypt) {
+        unsigned char nonce[8];
+        if (!random_bytes(nonce, sizeof(nonce))) {
+            fail(b, f, "Error al generar el nonce para");
+            return false;
+        }
+        for (int i = 0; i < 8; i++) f.c.nonce |= static_cast<uint64_t>(nonce[i]) << (8 * i);
+        keyed_header(f.c, header);
+        if (!pwrite_all(f.fd_out, header, sizeof(header), 0)) {
+            fail(b, f, "Error al escribir la cabecera de");
+            return false;
+        }
+        return true;
+    }
+
+    switch (read_keyed_header(f.fd_in, f.size, f.c)) {
+    case HEADER_MISSING:
+        fail(b, f, "Error: no fue encriptado con clave:");
+        return false;
+    case HEADER_WRONG_KEY:
+        fail(b, f, "Error: la clave no corresponde a");
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Abre el original y, fuera del modo en el lugar, el temporal junto a él
+static void open_file_job(batch &b, file_job &f) {
+    f.start = std::chrono::steady_clock::now();
+    f.fd_in = open(f.path.c_str(), b.in_place ? O_RDWR : O_RDONLY);
+    if (f.fd_in < 0) {
+        fail(b, f, "Error al abrir el archivo");
+        return;
+    }
+    struct stat info;
+    if (fstat(f.fd_in, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size != f.size) {
+        // Los tramos se calcularon con el tamaño de antes: si cambió, el resultado quedaría incompleto
+        errno = 0;
+        fail(b, f, "Error: cambió de tamaño o no es un archivo regular:");
+        return;
+    }
+    f.c = b.base;
+    if (b.in_place) {  // Solo en el modo XOR: con clave el tamaño cambia por la cabecera
+        f.fd_out = f.fd_in;
+        return;
+    }
+    f.fd_out = open_temp_beside(f.path, f.temp_path);
+    if (f.fd_out < 0) {
+        fail(b, f, "Error al crear el archivo temporal de salida para");
         return;
     }
+    if (ftruncate(f.fd_out, b.out_base + f.data_size) != 0) {
+        fail(b, f, "Error al reservar el archivo temporal de");
+        return;
+    }
+    if (b.base.keystream) prepare_keyed(b, f);
+}
+
+// Lo hace el hilo que termina el último tramo: sincroniza, reemplaza el original e informa
+static void finish_file_job(batch &b, file_job &f) {
+    if (!f.failed && fsync(f.fd_out) != 0) fail(b, f, "Error al sincronizar");
+    if (!f.failed && !b.in_place && !commit_temp(f.fd_out, f.temp_path, f.path)) {
+        fail(b, f, "Error al reemplazar el archivo original");
+    }
+    if (!f.temp_path.empty()) unlink(f.temp_path.c_str());
+    if (f.fd_out >= 0 && f.fd_out != f.fd_in) close(f.fd_out);
+    if (f.fd_in >= 0) close(f.fd_in);
 
-    int fd_out = open(processed_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-    if (fd_out < 0) {
-        perror("Error al abrir el archivo de salida");
-        close(fd_in);
+    if (f.failed) {
+        b.failures++;
         return;
     }
+    double seconds = elapsed_seconds(f.start);
+    b.done++;
+    b.bytes += static_cast<unsigned long long>(f.data_size);
+    std::lock_guard<std::mutex> lock(b.output);
+    std::cout << "Archivo procesado y reemplazado: " << f.path << " (" << std::fixed << std::setprecision(1)
+              << to_mb(f.data_size) << " MB, " << (seconds > 0 ? to_mb(f.data_size) / seconds : 0.0) << " MB/s)\n";
+}
+
+// Cada hilo toma el siguiente tramo libre con sus propios buffers, hasta que no quedan tramos
+static void run_worker(batch &b) {
+    io_engine engine(b.io, b.buffer_size);
+    for (;;) {
+        size_t i = b.next.fetch_add(1);
+        if (i >= b.ranges.size()) return;
+        range_job &r = b.ranges[i];
+        file_job &f = *r.file;
+        std::call_once(f.opened, open_file_job, std::ref(b), std::ref(f));
+        if (!f.failed && !transform_range(engine, f.fd_in, b.in_base, f.fd_out, b.out_base, r.offset, r.length, f.c)) {
+            fail(b, f, "Error al leer o escribir");
+        }
+        if (f.pending.fetch_sub(1) == 1) finish_file_job(b, f);
+    }
+}
+
+// Agrega un archivo regular al lote, salvo que ya esté: se procesaría dos veces a la vez, y en el
+// modo XOR el segundo pase además lo dejaría como estaba
+static void add_file(batch &b, std::set<std::pair<dev_t, ino_t>> &seen, const std::string &path,
+                     const struct stat &info) {
+    if (!seen.insert(std::make_pair(info.st_dev, info.st_ino)).second) return;
+    // Un archivo más chico que la cabecera igual se agrega, para informar el error al abrirlo
+    off_t data_size = std::max<off_t>(0, info.st_size - b.in_base);
+    b.files.emplace_back(path, info.st_size, data_size);
+}
+
+// Recorre un directorio de forma recursiva. Los enlaces simbólicos de adentro se saltean, así no
+// hay ciclos ni archivos de afuera del árbol.
+static bool collect_directory(batch &b, std::set<std::pair<dev_t, ino_t>> &seen, const std::string &dir) {
+    DIR *handle = opendir(dir.c_str());
+    if (!handle) {
+        report_error(b, "Error al abrir el directorio", dir);
+        return false;
+    }
+    bool ok = true;
+    std::vector<std::string> names;
+    while (struct dirent *entry = readdir(handle)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) names.push_back(entry->d_name);
+    }
+    closedir(handle);
+    std::sort(names.begin(), names.end());  // Orden estable en los mensajes
 
-    char buffer[BUFFER_SIZE];
-    ssize_t bytes_read;
-    while ((bytes_read = read(fd_in, buffer, BUFFER_SIZE)) > 0) {
-        for (ssize_t i = 0; i < bytes_read; i++) {
-            buffer[i] ^= XOR_KEY;  // Aplicar XOR para encriptar/desencriptar
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string path = dir == "/" ? "/" + names[i] : dir + "/" + names[i];
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0) {
+            report_error(b, "Error al consultar", path);
+            ok = false;
+        } else if (S_ISDIR(info.st_mode)) {
+            ok = collect_directory(b, seen, path) && ok;
+        } else if (S_ISREG(info.st_mode)) {
+            add_file(b, seen, path, info);
         }
-        write(fd_out, buffer, bytes_read);
     }
+    return ok;
+}
 
-    close(fd_in);
-    close(fd_out);
+// Encripta o desencripta todos los archivos indicados; los directorios se recorren de forma
+// recursiva. Sin 'key' se usa el XOR con la clave fija, donde encriptar y desencriptar es la misma
+// operación; con 'key' (8 palabras de 32 bits) se usa ChaCha20. Los archivos se reparten entre
+// 'jobs' hilos, y los de más de RANGE_SPLIT_MB se parten en tramos de ese tamaño para que varios
+// hilos trabajen sobre el mismo.
+bool encrypt_decrypt(const std::vector<std::string> &paths, size_t buffer_size, io_backend io, bool in_place,
+                     unsigned jobs, const uint32_t *key, bool decrypt) {
+    batch b;
+    init_cipher(b.base, key);
+    if (key) (decrypt ? b.in_base : b.out_base) = KEYED_HEADER_SIZE;
+    b.buffer_size = buffer_size;
+    b.io = io;
+    b.in_place = in_place;
+    b.decrypt = decrypt;
 
-    // Reemplazar el archivo original con el archivo que ya fue encriptado o desencriptado segun lo que elija el usuario
-    std::string command_mv = "mv " + processed_file + " " + std::string(input_file);
-    system(command_mv.c_str());
+    bool ok = true;
+    std::set<std::pair<dev_t, ino_t>> seen;
+    for (size_t i = 0; i < paths.size(); i++) {
+        struct stat info;
+        if (stat(paths[i].c_str(), &info) != 0) {
+            report_error(b, "Error al abrir", paths[i]);
+            ok = false;
+        } else if (S_ISDIR(info.st_mode)) {
+            ok = collect_directory(b, seen, paths[i]) && ok;
+        } else if (S_ISREG(info.st_mode)) {
+            add_file(b, seen, paths[i], info);
+        } else {
+            std::cerr << "Error: " << paths[i] << " no es un archivo regular\n";
+            ok = false;
+        }
+    }
+
+    const off_t split = static_cast<off_t>(RANGE_SPLIT_MB) * 1024 * 1024;
+    for (std::deque<file_job>::iterator f = b.files.begin(); f != b.files.end(); ++f) {
+        off_t offset = 0;
+        do {  // Un archivo vacío igual lleva un tramo, para crearlo y confirmarlo
+            range_job r = {&*f, offset, std::min(split, f->data_size - offset)};
+            b.ranges.push_back(r);
+            f->pending++;
+            offset += r.length;
+        } while (offset < f->data_size);
+    }
 
-    // Eliminar la copia temporal del archivo original
-    std::string command_rm = "rm " + temp_file;
-    system(command_rm.c_str());
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, b.ranges.size()));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < jobs; i++) workers.push_back(std::thread(run_worker, std::ref(b)));
+    run_worker(b);  // El hilo principal también trabaja
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
 
-    std::cout << "Archivo procesado y reemplazado: " << input_file << "\n";
+    if (b.files.size() > 1) {
+        double seconds = elapsed_seconds(start);
+        std::cout << "Procesados " << b.done << " de " << b.files.size() << " archivos, " << std::fixed
+                  << std::setprecision(1) << to_mb(b.bytes) << " MB en " << std::setprecision(2) << seconds
+                  << " s (" << std::setprecision(1) << (seconds > 0 ? to_mb(b.bytes) / seconds : 0.0)
+                  << " MB/s, " << jobs << (jobs == 1 ? " hilo" : " hilos") << ")\n";
+    }
+    return ok && b.failures == 0;
+}
+
+// write() a un descriptor que puede ser una tubería: se repite hasta escribir todo
+static bool write_all(int fd, const unsigned char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Archivo encriptado abierto para leer tramos desencriptados sin modificarlo
+struct encrypted_reader {
+    int fd;
+    cipher c;
+    off_t data_base;  // Dónde empiezan los datos: después de la cabecera en el modo con clave
+    off_t data_size;
+};
+
+// Abre 'path' para leer tramos. Sin 'key' es el modo XOR; con clave lee el nonce de la cabecera
+// y verifica la clave. Informa el error y devuelve false si no se puede.
+static bool open_encrypted(const char *path, const uint32_t *key, encrypted_reader &r) {
+    init_cipher(r.c, key);
+    r.data_base = 0;
+    r.fd = open(path, O_RDONLY);
+    if (r.fd < 0) {
+        perror("Error al abrir el archivo");
+        return false;
+    }
+    struct stat info;
+    if (fstat(r.fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        std::cerr << "Error: " << path << " no es un archivo regular\n";
+        close(r.fd);
+        return false;
+    }
+    if (key) {
+        header_status status = read_keyed_header(r.fd, info.st_size, r.c);
+        if (status != HEADER_OK) {
+            std::cerr << (status == HEADER_MISSING ? "Error: no fue encriptado con clave: "
+                                                   : "Error: la clave no corresponde a ") << path << "\n";
+            close(r.fd);
+            return false;
+        }
+        r.data_base = KEYED_HEADER_SIZE;
+    }
+    r.data_size = info.st_size - r.data_base;
+    return true;
+}
+
+// Lee y desencripta los datos [offset, offset + size) en 'out'. Devuelve los bytes leídos, que
+// solo son menos que 'size' al llegar al final, o -1 con errno si falla la lectura.
+static ssize_t read_decrypted(const encrypted_reader &r, uint64_t offset, unsigned char *out, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread(r.fd, out + total, size - total, r.data_base + static_cast<off_t>(offset + total));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    // Los dos modos dependen solo de la posición de cada byte: no hace falta leer lo anterior
+    apply_cipher(r.c, out, total, offset);
+    return static_cast<ssize_t>(total);
+}
+
+// Desencripta solo los datos [offset, offset + length) de 'path' (sin contar la cabecera) y los
+// escribe en out_fd, sin modificar el archivo. Un tramo que pasa del final se recorta;
+// length == UINT64_MAX es hasta el final.
+bool decrypt_range(const char *path, const uint32_t *key, uint64_t offset, uint64_t length, int out_fd,
+                   size_t buffer_size) {
+    encrypted_reader r;
+    if (!open_encrypted(path, key, r)) return false;
+    uint64_t data_size = static_cast<uint64_t>(r.data_size);
+    if (offset > data_size) {
+        std::cerr << "Error: el tramo empieza en " << offset << ", después del final de " << path << " ("
+                  << data_size << " bytes)\n";
+        close(r.fd);
+        return false;
+    }
+    length = std::min(length, data_size - offset);
+
+    std::vector<unsigned char> buffer(static_cast<size_t>(std::min<uint64_t>(buffer_size, std::max<uint64_t>(length, 1))));
+    bool ok = true;
+    while (ok && length > 0) {
+        ssize_t n = read_decrypted(r, offset, buffer.data(), static_cast<size_t>(std::min<uint64_t>(length, buffer.size())));
+        if (n <= 0) {
+            if (n < 0) perror("Error al leer el archivo");
+            else std::cerr << "Error: " << path << " se achicó mientras se leía\n";
+            ok = false;
+        } else if (!write_all(out_fd, buffer.data(), static_cast<size_t>(n))) {
+            perror("Error al escribir la salida");
+            ok = false;
+        } else {
+            offset += static_cast<uint64_t>(n);
+            length -= static_cast<uint64_t>(n);
+        }
+    }
+    close(r.fd);
+    return ok;
+}
+
+// "offset:largo" en bytes; sin largo ("offset:") es hasta el final
+static bool parse_range(const char *text, uint64_t &offset, uint64_t &length) {
+    char *end;
+    errno = 0;
+    if (!isdigit(static_cast<unsigned char>(*text))) return false;
+    offset = strtoull(text, &end, 10);
+    if (errno != 0 || *end != ':') return false;
+    text = end + 1;
+    if (*text == '\0') {
+        length = UINT64_MAX;
+        return true;
+    }
+    if (!isdigit(static_cast<unsigned char>(*text))) return false;
+    length = strtoull(text, &end, 10);
+    return errno == 0 && *end == '\0';
 }
 
 void show_help() {
-    std::cout << "Uso: Encriptador [opciones] <archivo>\n"
+    std::cout << "Uso: Encriptador [opciones] <archivo|directorio>...\n"
               << "Opciones:\n"
               << "  -h, --help       Muestra este mensaje\n"
               << "  -v, --version    Muestra la versión del programa\n"
               << "  -e <archivo>     Encripta el archivo (modifica el original)\n"
-              << "  -d <archivo>     Desencripta el archivo (modifica el original)\n";
+              << "  -d <archivo>     Desencripta el archivo (modifica el original)\n"
+              << "  -i, --in-place   Transforma sobre el mismo archivo, sin temporal (no es seguro ante cortes)\n"
+              << "  -b <KB>          Tamaño del buffer de lectura/escritura (por defecto "
+              << DEFAULT_BUFFER_KB << ", mínimo " << MIN_BUFFER_KB << ")\n"
+              << "  -j <hilos>       Hilos de trabajo (por defecto, uno por núcleo)\n"
+              << "  --io <modo>      E/S: uring (por defecto, si el kernel lo permite), hilos o sincronico\n"
+              << "  -k <archivo>     Cifra con ChaCha20 y la clave del archivo (32 bytes o 64 dígitos\n"
+              << "                   hexadecimales); sin -k se usa " KEY_ENV " si está definida\n"
+              << "  --to-stdout      Con -d, escribe el archivo desencriptado en la salida estándar\n"
+              << "                   sin modificarlo\n"
+              << "  --range <o:n>    Con --to-stdout, solo los n bytes desde la posición o (\"o:\" hasta el final)\n"
+              << "Se pueden indicar varios archivos y directorios; los directorios se recorren\n"
+              << "de forma recursiva.\n";
 }
 
 void show_version() {
-    std::cout << "Encriptador v1.1\n";
+    const char *xor_name, *chacha_name;
+    select_xor_kernel(&xor_name);
+    select_chacha_kernel(&chacha_name);
+    std::cout << "Encriptador v1.5 (XOR " << xor_name << ", ChaCha20 " << chacha_name << ", E/S "
+              << io_backend_name(probe_io_backend(IO_URING)) << ")\n";
+}
+
+// Lee la clave del archivo indicado con -k, o de la variable de entorno si no se indicó.
+// 'found' queda en false si no hay ninguna de las dos y se usa el modo XOR.
+static bool load_key(const char *key_file, uint32_t key[8], bool &found) {
+    found = false;
+    std::string text;
+    if (key_file) {
+        int fd = open(key_file, O_RDONLY);
+        if (fd < 0) {
+            perror("Error al abrir el archivo de la clave");
+            return false;
+        }
+        char chunk[256];
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) > 0 && text.size() < 4096) text.append(chunk, n);
+        close(fd);
+    } else if (const char *value = getenv(KEY_ENV)) {
+        text = value;
+    } else {
+        return true;
+    }
+    found = true;
+    if (!parse_key(text.data(), text.size(), key)) {
+        std::cerr << "La clave debe tener 32 bytes o 64 dígitos hexadecimales.\n";
+        return false;
+    }
+    return true;
 }
 
 int main(int argc, char *argv[]) {
@@ -71,18 +935,92 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
-        show_help();
-    } else if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0) {
-        show_version();
-    } else if ((strcmp(argv[1], "-e") == 0 || strcmp(argv[1], "--encrypt") == 0) && argc == 3) {
-        encrypt_decrypt(argv[2]);
-    } else if ((strcmp(argv[1], "-d") == 0 || strcmp(argv[1], "--decrypt") == 0) && argc == 3) {
-        encrypt_decrypt(argv[2]);
-    } else {
+    std::vector<std::string> paths;
+    char mode = 0;  // 'e' o 'd'
+    const char *key_file = nullptr;
+    bool to_stdout = false;
+    const char *range = nullptr;
+    long buffer_kb = DEFAULT_BUFFER_KB;
+    bool in_place = false;
+    io_backend io = IO_URING;  // Si no está disponible, cada hilo pasa al doble buffer
+    long jobs = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            show_help();
+            return 0;
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
+            show_version();
+            return 0;
+        } else if ((strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--encrypt") == 0 ||
+                    strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--decrypt") == 0) && i + 1 < argc) {
+            char this_mode = argv[i][1] == '-' ? argv[i][2] : argv[i][1];
+            if (mode && mode != this_mode) {
+                std::cerr << "No se puede encriptar y desencriptar en la misma ejecución.\n";
+                return 1;
+            }
+            mode = this_mode;
+            paths.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--in-place") == 0) {
+            in_place = true;
+        } else if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--buffer") == 0) && i + 1 < argc) {
+            buffer_kb = atol(argv[++i]);
+            if (buffer_kb < MIN_BUFFER_KB || buffer_kb > MAX_BUFFER_KB) {
+                std::cerr << "El buffer debe estar entre " << MIN_BUFFER_KB << " y " << MAX_BUFFER_KB << " KB.\n";
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            jobs = atol(argv[++i]);
+            if (jobs < 1 || jobs > MAX_JOBS) {
+                std::cerr << "La cantidad de hilos debe estar entre 1 y " << MAX_JOBS << ".\n";
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--key") == 0) && i + 1 < argc) {
+            key_file = argv[++i];
+        } else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "uring") == 0) io = IO_URING;
+            else if (strcmp(argv[i], "hilos") == 0) io = IO_THREADS;
+            else if (strcmp(argv[i], "sincronico") == 0) io = IO_SYNC;
+            else {
+                std::cerr << "El modo de E/S debe ser uring, hilos o sincronico.\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--to-stdout") == 0) {
+            to_stdout = true;
+        } else if (strcmp(argv[i], "--range") == 0 && i + 1 < argc) {
+            range = argv[++i];
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);  // Más archivos después de -e/-d
+        } else {
+            std::cerr << "Opción no reconocida. Use -h para ayuda.\n";
+            return 1;
+        }
+    }
+
+    if (!mode) {
         std::cerr << "Opción no reconocida. Use -h para ayuda.\n";
         return 1;
     }
-
-    return 0;
+    uint32_t key[8];
+    bool keyed;
+    if (!load_key(key_file, key, keyed)) return 1;
+    if (range || to_stdout) {
+        uint64_t offset = 0, length = UINT64_MAX;
+        if (!to_stdout || mode != 'd' || paths.size() != 1 || in_place) {
+            std::cerr << "--to-stdout necesita -d con un solo archivo, y --range necesita --to-stdout.\n";
+            return 1;
+        }
+        if (range && !parse_range(range, offset, length)) {
+            std::cerr << "El tramo debe tener la forma offset:largo, en bytes.\n";
+            return 1;
+        }
+        return decrypt_range(paths[0].c_str(), keyed ? key : nullptr, offset, length, STDOUT_FILENO,
+                             static_cast<size_t>(buffer_kb) * 1024) ? 0 : 1;
+    }
+    if (keyed && in_place) {
+        std::cerr << "El modo -i no se puede usar con clave: la cabecera cambia el tamaño del archivo.\n";
+        return 1;
+    }
+    return encrypt_decrypt(paths, static_cast<size_t>(buffer_kb) * 1024, io, in_place, static_cast<unsigned>(jobs),
+                           keyed ? key : nullptr, mode == 'd') ? 0 : 1;
 }
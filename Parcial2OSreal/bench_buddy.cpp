@@ -0,0 +1,60 @@
+// Microbenchmark del BuddyAllocator: asignaciones por segundo con distintos tamaños de arena.
+// Compilar: g++ -std=c++11 -O2 bench_buddy.cpp buddyAllocator.cpp -o bench_buddy
+#include "buddyAllocator.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+// Mezcla de asignaciones y liberaciones: bloques pequeños (metadatos) y grandes (buffers de imagen)
+double medirAsignacionesPorSegundo(size_t arena, double segundos) {
+    BuddyAllocator buddy(arena);
+    mt19937 rng(12345);
+    uniform_int_distribution<int> exponente(6, 20);
+    vector<void*> vivos;
+    vivos.reserve(256);
+
+    size_t asignaciones = 0;
+    auto inicio = chrono::steady_clock::now();
+    chrono::duration<double> transcurrido(0);
+
+    while (transcurrido.count() < segundos) {
+        for (int i = 0; i < 256; ++i) {
+            if (vivos.size() < 128 && (rng() & 1)) {
+                size_t tam = (size_t(1) << exponente(rng)) - (rng() % 64);
+                if (tam > arena / 8) tam = arena / 8;
+                void* p = buddy.allocate(tam);
+                if (p) {
+                    vivos.push_back(p);
+                    asignaciones++;
+                }
+            } else if (!vivos.empty()) {
+                size_t k = rng() % vivos.size();
+                buddy.deallocate(vivos[k]);
+                vivos[k] = vivos.back();
+                vivos.pop_back();
+            }
+        }
+        transcurrido = chrono::steady_clock::now() - inicio;
+    }
+
+    for (void* p : vivos) buddy.deallocate(p);
+    return asignaciones / transcurrido.count();
+}
+
+int main(int argc, char* argv[]) {
+    double segundos = argc > 1 ? atof(argv[1]) : 1.0;
+    const size_t arenas[] = { 1u << 20, 4u << 20, 16u << 20, 32u << 20, 128u << 20 };
+
+    cout << "=== Benchmark BuddyAllocator ===" << endl;
+    cout << setw(12) << "Arena (MB)" << setw(20) << "Asignaciones/s" << endl;
+    for (size_t arena : arenas) {
+        double ops = medirAsignacionesPorSegundo(arena, segundos);
+        cout << setw(12) << (arena >> 20) << setw(20) << fixed << setprecision(0) << ops << endl;
+    }
+    return 0;
+}
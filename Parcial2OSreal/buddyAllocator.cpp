@@ -1,4 +1,9 @@
-#include "BuddyAllocator.h"
+#include "buddyAllocator.h"
+#include <algorithm>
+
+const size_t BuddyAllocator::MIN_SHIFT;
+const size_t BuddyAllocator::MIN_BLOCK;
+const size_t BuddyAllocator::NO_BLOCK;
 
 size_t BuddyAllocator::nextPowerOfTwo(size_t n) {
     if (n == 0) return 1;
@@ -12,83 +17,133 @@ size_t BuddyAllocator::nextPowerOfTwo(size_t n) {
     return n + 1;
 }
 
-BuddyAllocator::BuddyAllocator(size_t size) 
-    : totalSize(nextPowerOfTwo(size)), memoryBlocks(totalSize, 0) {}
+BuddyAllocator::BuddyAllocator(size_t size)
+    : totalSize(nextPowerOfTwo(size < MIN_BLOCK ? MIN_BLOCK : size)),
+      maxOrder(0), usedSize(0), memoryBlocks(totalSize, 0) {
+    maxOrder = orderOf(totalSize);
+    freeBlocks.assign(maxOrder + 1, NO_BLOCK);
+
+    // Un bit por nodo del árbol (2^(maxOrder+1) nodos, la raíz es el nodo 1)
+    size_t nodes = size_t(2) << maxOrder;
+    freeMap.assign((nodes + 63) / 64, 0);
+
+    // Al inicio toda la memoria es un único bloque libre del orden máximo
+    pushFree(0, maxOrder);
+}
+
+// Orden de un bloque: size == MIN_BLOCK << orden (size ya es potencia de 2)
+size_t BuddyAllocator::orderOf(size_t size) const {
+    size_t order = 0;
+    while ((MIN_BLOCK << order) < size) order++;
+    return order;
+}
+
+// Número de nodo en el árbol implícito para el bloque (índice, orden)
+size_t BuddyAllocator::nodeOf(size_t index, size_t order) const {
+    size_t level = maxOrder - order;
+    return (size_t(1) << level) + (index >> (order + MIN_SHIFT));
+}
+
+bool BuddyAllocator::isFree(size_t node) const {
+    return (freeMap[node >> 6] >> (node & 63)) & 1;
+}
+
+void BuddyAllocator::setFree(size_t node, bool free) {
+    if (free) freeMap[node >> 6] |= uint64_t(1) << (node & 63);
+    else      freeMap[node >> 6] &= ~(uint64_t(1) << (node & 63));
+}
+
+BuddyAllocator::FreeNode* BuddyAllocator::freeNodeAt(size_t index) {
+    return reinterpret_cast<FreeNode*>(&memoryBlocks[index]);
+}
+
+// Inserta el bloque al inicio de la lista libre de su orden: O(1)
+void BuddyAllocator::pushFree(size_t index, size_t order) {
+    FreeNode* node = freeNodeAt(index);
+    node->prev = NO_BLOCK;
+    node->next = freeBlocks[order];
+    if (node->next != NO_BLOCK) {
+        freeNodeAt(node->next)->prev = index;
+    }
+    freeBlocks[order] = index;
+    setFree(nodeOf(index, order), true);
+}
+
+// Saca un bloque cualquiera de la lista libre de su orden: O(1)
+void BuddyAllocator::removeFree(size_t index, size_t order) {
+    FreeNode* node = freeNodeAt(index);
+    if (node->prev != NO_BLOCK) {
+        freeNodeAt(node->prev)->next = node->next;
+    } else {
+        freeBlocks[order] = node->next;
+    }
+    if (node->next != NO_BLOCK) {
+        freeNodeAt(node->next)->prev = node->prev;
+    }
+    setFree(nodeOf(index, order), false);
+}
 
 void* BuddyAllocator::allocate(size_t size) {
     if (size == 0) return nullptr;
-    
+
     size = nextPowerOfTwo(size);
+    if (size < MIN_BLOCK) size = MIN_BLOCK;
     if (size > totalSize) return nullptr;
 
-    // Buscar el primer bloque libre del tamaño adecuado
-    for (size_t i = 0; i <= totalSize - size; i += size) {
-        if (memoryBlocks[i] == 0) {
-            bool blockFree = true;
-            // Verificar que todo el bloque esté libre
-            for (size_t j = i; j < i + size; ++j) {
-                if (memoryBlocks[j] != 0) {
-                    blockFree = false;
-                    break;
-                }
-            }
-            
-            if (blockFree) {
-                // Marcar como ocupado
-                for (size_t j = i; j < i + size; ++j) {
-                    memoryBlocks[j] = 1;
-                }
-                allocatedBlocks[i] = size;
-                return &memoryBlocks[i];
-            }
-        }
+    // Buscar la lista libre no vacía más pequeña que sirva
+    size_t order = orderOf(size);
+    size_t current = order;
+    while (current <= maxOrder && freeBlocks[current] == NO_BLOCK) {
+        current++;
+    }
+    if (current > maxOrder) return nullptr;
+
+    size_t index = freeBlocks[current];
+    removeFree(index, current);
+
+    // Dividir el bloque hasta el orden pedido; la mitad derecha queda libre
+    while (current > order) {
+        current--;
+        pushFree(index + (MIN_BLOCK << current), current);
     }
-    return nullptr;
+
+    allocatedBlocks[index] = size;
+    usedSize += size;
+    return &memoryBlocks[index];
 }
 
 void BuddyAllocator::deallocate(void* ptr) {
     if (!ptr) return;
 
     size_t index = static_cast<char*>(ptr) - &memoryBlocks[0];
-    if (index >= totalSize || !allocatedBlocks.count(index)) return;
+    if (index >= totalSize) return;
+
+    std::map<size_t, size_t>::iterator it = allocatedBlocks.find(index);
+    if (it == allocatedBlocks.end()) return;
+
+    size_t size = it->second;
+    allocatedBlocks.erase(it);
+    usedSize -= size;
 
-    size_t size = allocatedBlocks[index];
-    // Marcar como libre
-    for (size_t i = index; i < index + size; ++i) {
-        memoryBlocks[i] = 0;
-    }
-    allocatedBlocks.erase(index);
-    
     // Intentar fusionar con buddies
     mergeBuddies(index, size);
 }
 
 void BuddyAllocator::mergeBuddies(size_t index, size_t size) {
-    size_t buddyIndex = index ^ size;
-    
-    while (size < totalSize) {
-        // Verificar si el buddy está libre y es del mismo tamaño
-        if (buddyIndex < totalSize && memoryBlocks[buddyIndex] == 0) {
-            bool buddyCompletelyFree = true;
-            for (size_t i = buddyIndex; i < buddyIndex + size; ++i) {
-                if (memoryBlocks[i] != 0) {
-                    buddyCompletelyFree = false;
-                    break;
-                }
-            }
-            
-            if (buddyCompletelyFree) {
-                // Fusionar bloques
-                size *= 2;
-                index = std::min(index, buddyIndex);
-                buddyIndex = index ^ size;
-            } else {
-                break;
-            }
-        } else {
-            break;
-        }
+    size_t order = orderOf(size);
+
+    while (order < maxOrder) {
+        // El buddy sólo se puede fusionar si está entero en la lista libre del mismo orden
+        size_t buddyIndex = index ^ size;
+        if (!isFree(nodeOf(buddyIndex, order))) break;
+
+        removeFree(buddyIndex, order);
+        index = std::min(index, buddyIndex);
+        size *= 2;
+        order++;
     }
+
+    pushFree(index, order);
 }
 
 // Funciones de monitoreo
@@ -97,11 +152,7 @@ size_t BuddyAllocator::getTotalMemory() const {
 }
 
 size_t BuddyAllocator::getUsedMemory() const {
-    size_t used = 0;
-    for (const auto& block : allocatedBlocks) {
-        used += block.second;
-    }
-    return used;
+    return usedSize;
 }
 
 size_t BuddyAllocator::getFreeMemory() const {
@@ -113,10 +164,22 @@ void BuddyAllocator::printMemoryStatus() const {
     std::cout << "Total: " << getTotalMemory() << " bytes\n";
     std::cout << "En uso: " << getUsedMemory() << " bytes\n";
     std::cout << "Libres: " << getFreeMemory() << " bytes\n";
-    
+
     std::cout << "Bloques asignados:\n";
     for (const auto& block : allocatedBlocks) {
-        std::cout << " - Dirección: " << block.first 
+        std::cout << " - Dirección: " << block.first
                   << ", Tamaño: " << block.second << " bytes\n";
     }
-}
\ No newline at end of file
+
+    std::cout << "Bloques libres por tamaño:\n";
+    for (size_t order = 0; order <= maxOrder; ++order) {
+        size_t count = 0;
+        for (size_t i = freeBlocks[order]; i != NO_BLOCK;
+             i = reinterpret_cast<const FreeNode*>(&memoryBlocks[i])->next) {
+            count++;
+        }
+        if (count > 0) {
+            std::cout << " - " << (MIN_BLOCK << order) << " bytes: " << count << "\n";
+        }
+    }
+}
@@ -4,23 +4,44 @@
 #include <vector>
 #include <map>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 
 class BuddyAllocator {
 private:
+    static const size_t MIN_SHIFT = 6;
+    static const size_t MIN_BLOCK = size_t(1) << MIN_SHIFT; // Bloque mínimo (una línea de caché)
+    static const size_t NO_BLOCK = static_cast<size_t>(-1);
+
+    // Enlaces de la lista libre, guardados dentro del propio bloque libre
+    struct FreeNode {
+        size_t prev;
+        size_t next;
+    };
+
     size_t totalSize;
+    size_t maxOrder;                          // totalSize == MIN_BLOCK << maxOrder
+    size_t usedSize;
     std::vector<char> memoryBlocks;
     std::map<size_t, size_t> allocatedBlocks; // Bloques asignados: índice -> tamaño
-    std::map<size_t, size_t> freeBlocks;      // Bloques libres: índice -> tamaño
+    std::vector<size_t> freeBlocks;           // Listas libres: orden -> índice del primer bloque libre
+    std::vector<uint64_t> freeMap;            // Bitmap: nodo del árbol buddy -> está en una lista libre
 
     size_t nextPowerOfTwo(size_t n);
+    size_t orderOf(size_t size) const;
+    size_t nodeOf(size_t index, size_t order) const;
+    bool isFree(size_t node) const;
+    void setFree(size_t node, bool free);
+    FreeNode* freeNodeAt(size_t index);
+    void pushFree(size_t index, size_t order);
+    void removeFree(size_t index, size_t order);
     void mergeBuddies(size_t index, size_t size);
 
 public:
     BuddyAllocator(size_t size);
     void* allocate(size_t size);
     void deallocate(void* ptr);
-    
+
     // Funciones de monitoreo
     size_t getTotalMemory() const;
     size_t getUsedMemory() const;
@@ -28,4 +49,4 @@ public:
     void printMemoryStatus() const;
 };
 
-#endif // BUDDYALLOCATOR_H
\ No newline at end of file
+#endif // BUDDYALLOCATOR_H
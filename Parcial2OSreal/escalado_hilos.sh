@@ -0,0 +1,15 @@
+#!/bin/sh
+# Mide la rotación con 1..N hilos sobre las imágenes de referencia.
+# Uso: ./escalado_hilos.sh [angulo] [max_hilos]
+ANGULO=${1:-45}
+MAX_HILOS=${2:-$(nproc)}
+
+for imagen in TETO.jpg TETOTETO.jpg TETOTETO3.jpg; do
+    echo "=== $imagen (rotar $ANGULO) ==="
+    hilos=1
+    while [ "$hilos" -le "$MAX_HILOS" ]; do
+        ./image_scaler "$imagen" /tmp/escalado_hilos.png -rotar "$ANGULO" 0 --threads "$hilos" | grep "Tiempo de ejecución"
+        hilos=$((hilos * 2))
+    done
+done
+rm -f /tmp/escalado_hilos.png
@@ -1,5 +1,326 @@
 #include "image.h"
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IMAGE_X86_SIMD 1
+#endif
+
+const int ImageProcessor::TILE_SIZE;
+
+namespace {
+
+// Tabla de un eje para el escalado bilineal: por cada coordenada destino, los dos vecinos
+// en origen (ya multiplicados por el tamaño de pixel) y el peso del segundo en 1/256.
+struct AxisTable {
+    std::vector<int> first;
+    std::vector<int> second;
+    std::vector<uint16_t> weight;
+};
+
+// Mismas coordenadas que el cálculo por pixel original; el peso se redondea a 8 bits,
+// el error por eje es < 0.5 niveles y el resultado queda a ±1 del cálculo en float.
+AxisTable buildAxisTable(int dstSize, int srcSize, double scaleFactor, int stride) {
+    AxisTable table;
+    table.first.resize(dstSize);
+    table.second.resize(dstSize);
+    table.weight.resize(dstSize);
+
+    for (int i = 0; i < dstSize; ++i) {
+        float srcPos = i / scaleFactor;
+        int i1 = std::min(static_cast<int>(srcPos), srcSize - 1);
+        int i2 = std::min(i1 + 1, srcSize - 1);
+        float d = srcPos - i1;
+        int w = static_cast<int>(d * 256.0f + 0.5f);
+
+        table.first[i] = i1 * stride;
+        table.second[i] = i2 * stride;
+        table.weight[i] = static_cast<uint16_t>(std::max(0, std::min(w, 256)));
+    }
+    return table;
+}
+
+// Valores de salida que la pasada horizontal con SIMD resuelve juntos (un registro de 8 x uint16)
+const int SHUFFLE_GROUP = 8;
+
+// Tabla de la pasada horizontal con SIMD. Cada grupo de 8 valores (pixel y canal) toma sus
+// vecinos de dos ventanas de 16 bytes de la fila de origen, una para cada mitad del grupo;
+// las máscaras de pshufb dejan en cada valor de 16 bits el primer vecino en el byte bajo y el
+// segundo en el alto. Los grupos cuyos vecinos no caben en las ventanas (reducciones por
+// debajo de ~0.3) quedan marcados y se calculan con el bucle escalar.
+struct ShuffleTable {
+    std::vector<int> base;          // Inicio de las dos ventanas de cada grupo; -1 si va escalar
+    std::vector<uint8_t> mask;      // 32 bytes por grupo: máscara de la ventana izquierda y la derecha
+    std::vector<uint16_t> weight;   // Peso del segundo vecino de cada valor, en 1/256
+};
+
+ShuffleTable buildShuffleTable(const AxisTable& cols, int channels, int rowBytes) {
+    ShuffleTable table;
+    int values = static_cast<int>(cols.weight.size()) * channels;
+    int groups = values / SHUFFLE_GROUP;
+    table.base.resize(2 * groups);
+    table.mask.assign(2 * 16 * groups, 0x80);  // 0x80 deja el byte en 0
+    table.weight.resize(values);
+    for (int v = 0; v < values; ++v) table.weight[v] = cols.weight[v / channels];
+
+    const int half = SHUFFLE_GROUP / 2;
+    for (int g = 0; g < groups; ++g) {
+        for (int side = 0; side < 2; ++side) {
+            int start = g * SHUFFLE_GROUP + side * half;
+            // Al ampliar, pixeles seguidos repiten vecino y el canal hace que los bytes no sean
+            // crecientes: los límites de la ventana salen de todos los valores de la mitad
+            int low = INT_MAX, high = -1;
+            for (int v = start; v < start + half; ++v) {
+                low = std::min(low, cols.first[v / channels] + v % channels);
+                high = std::max(high, cols.second[v / channels] + v % channels);
+            }
+            // La ventana no pasa del final de la fila, así nunca se lee fuera de la imagen
+            int base = std::min(low, rowBytes - 16);
+            if (base < 0 || high - base >= 16) {
+                table.base[2 * g] = table.base[2 * g + 1] = -1;
+                break;
+            }
+            table.base[2 * g + side] = base;
+            uint8_t* mask = &table.mask[32 * g + 16 * side];
+            for (int v = start; v < start + half; ++v) {
+                int j = v - g * SHUFFLE_GROUP;
+                mask[2 * j] = static_cast<uint8_t>(cols.first[v / channels] + v % channels - base);
+                mask[2 * j + 1] = static_cast<uint8_t>(cols.second[v / channels] + v % channels - base);
+            }
+        }
+    }
+    return table;
+}
+
+// Pasada horizontal de los valores [start, end) de una fila de origen: punto fijo 8.8 (0..65280)
+void interpolateValues(const uchar* src, const AxisTable& cols, int channels, int start, int end, uint16_t* out) {
+    for (int v = start; v < end; ++v) {
+        int x = v / channels, c = v % channels;
+        unsigned w2 = cols.weight[x];
+        out[v] = static_cast<uint16_t>(src[cols.first[x] + c] * (256 - w2) + src[cols.second[x] + c] * w2);
+    }
+}
+
+typedef void (*InterpolateRowFn)(const uchar*, const AxisTable&, const ShuffleTable&, int, uint16_t*);
+
+void interpolateRowScalar(const uchar* src, const AxisTable& cols, const ShuffleTable&, int channels, uint16_t* out) {
+    int n = static_cast<int>(cols.weight.size());
+    for (int x = 0; x < n; ++x) {
+        const uchar* p1 = src + cols.first[x];
+        const uchar* p2 = src + cols.second[x];
+        unsigned w2 = cols.weight[x];
+        unsigned w1 = 256 - w2;
+        for (int c = 0; c < channels; ++c) {
+            out[x * channels + c] = static_cast<uint16_t>(p1[c] * w1 + p2[c] * w2);
+        }
+    }
+}
+
+// Pasada vertical: dst = (top * (256 - wy) + bottom * wy) >> 16
+typedef void (*BlendRowsFn)(const uint16_t*, const uint16_t*, unsigned, uchar*, int);
+
+void blendRowsScalar(const uint16_t* top, const uint16_t* bottom, unsigned wy, uchar* dst, int n) {
+    unsigned w1 = 256 - wy;
+    for (int i = 0; i < n; ++i) {
+        dst[i] = static_cast<uchar>((top[i] * w1 + bottom[i] * wy) >> 16);
+    }
+}
+
+#ifdef IMAGE_X86_SIMD
+// Producto completo de 16x16 bits sin signo usando mullo/mulhi
+__attribute__((target("sse2")))
+inline __m128i blend8SSE2(__m128i top, __m128i bottom, __m128i w1, __m128i w2) {
+    __m128i loA = _mm_mullo_epi16(top, w1), hiA = _mm_mulhi_epu16(top, w1);
+    __m128i loB = _mm_mullo_epi16(bottom, w2), hiB = _mm_mulhi_epu16(bottom, w2);
+    __m128i sumLo = _mm_add_epi32(_mm_unpacklo_epi16(loA, hiA), _mm_unpacklo_epi16(loB, hiB));
+    __m128i sumHi = _mm_add_epi32(_mm_unpackhi_epi16(loA, hiA), _mm_unpackhi_epi16(loB, hiB));
+    return _mm_packs_epi32(_mm_srli_epi32(sumLo, 16), _mm_srli_epi32(sumHi, 16));
+}
+
+__attribute__((target("sse2")))
+void blendRowsSSE2(const uint16_t* top, const uint16_t* bottom, unsigned wy, uchar* dst, int n) {
+    __m128i w1 = _mm_set1_epi16(static_cast<short>(256 - wy));
+    __m128i w2 = _mm_set1_epi16(static_cast<short>(wy));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = blend8SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i)), w1, w2);
+        __m128i b = blend8SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i + 8)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i + 8)), w1, w2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+    }
+    blendRowsScalar(top + i, bottom + i, wy, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i blend16AVX2(__m256i top, __m256i bottom, __m256i w1, __m256i w2) {
+    __m256i loA = _mm256_mullo_epi16(top, w1), hiA = _mm256_mulhi_epu16(top, w1);
+    __m256i loB = _mm256_mullo_epi16(bottom, w2), hiB = _mm256_mulhi_epu16(bottom, w2);
+    __m256i sumLo = _mm256_add_epi32(_mm256_unpacklo_epi16(loA, hiA), _mm256_unpacklo_epi16(loB, hiB));
+    __m256i sumHi = _mm256_add_epi32(_mm256_unpackhi_epi16(loA, hiA), _mm256_unpackhi_epi16(loB, hiB));
+    // unpack/pack trabajan dentro de cada carril de 128 bits, así que el orden se conserva
+    return _mm256_packs_epi32(_mm256_srli_epi32(sumLo, 16), _mm256_srli_epi32(sumHi, 16));
+}
+
+__attribute__((target("avx2")))
+void blendRowsAVX2(const uint16_t* top, const uint16_t* bottom, unsigned wy, uchar* dst, int n) {
+    __m256i w1 = _mm256_set1_epi16(static_cast<short>(256 - wy));
+    __m256i w2 = _mm256_set1_epi16(static_cast<short>(wy));
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = blend16AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(top + i)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom + i)), w1, w2);
+        __m256i b = blend16AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(top + i + 16)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom + i + 16)), w1, w2);
+        // packus intercala los carriles: se reordenan los bloques de 64 bits
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    blendRowsSSE2(top + i, bottom + i, wy, dst + i, n - i);
+}
+
+// p1 * (256 - w) + p2 * w = (p1 << 8) + (p2 - p1) * w: el resultado entra en 16 bits sin signo,
+// así que la cuenta con desborde de mullo da exactamente el mismo valor que la versión escalar
+__attribute__((target("ssse3")))
+inline __m128i interpolatePairsSSSE3(__m128i pairs, __m128i weight) {
+    __m128i first = _mm_and_si128(pairs, _mm_set1_epi16(0x00FF));
+    __m128i second = _mm_srli_epi16(pairs, 8);
+    return _mm_add_epi16(_mm_slli_epi16(first, 8), _mm_mullo_epi16(_mm_sub_epi16(second, first), weight));
+}
+
+__attribute__((target("ssse3")))
+inline void interpolateGroupSSSE3(const uchar* src, const ShuffleTable& shuffle, int g, uint16_t* out) {
+    const int* base = &shuffle.base[2 * g];
+    const __m128i* mask = reinterpret_cast<const __m128i*>(&shuffle.mask[32 * g]);
+    __m128i left = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + base[0])), _mm_loadu_si128(mask));
+    __m128i right = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + base[1])), _mm_loadu_si128(mask + 1));
+    __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&shuffle.weight[g * SHUFFLE_GROUP]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + g * SHUFFLE_GROUP),
+                     interpolatePairsSSSE3(_mm_or_si128(left, right), weight));
+}
+
+__attribute__((target("ssse3")))
+void interpolateRowSSSE3(const uchar* src, const AxisTable& cols, const ShuffleTable& shuffle, int channels, uint16_t* out) {
+    int groups = static_cast<int>(shuffle.base.size()) / 2;
+    for (int g = 0; g < groups; ++g) {
+        if (shuffle.base[2 * g] < 0) {
+            interpolateValues(src, cols, channels, g * SHUFFLE_GROUP, (g + 1) * SHUFFLE_GROUP, out);
+        } else {
+            interpolateGroupSSSE3(src, shuffle, g, out);
+        }
+    }
+    interpolateValues(src, cols, channels, groups * SHUFFLE_GROUP, static_cast<int>(shuffle.weight.size()), out);
+}
+
+// Dos grupos por vuelta, uno en cada carril de 128 bits (pshufb no cruza carriles)
+__attribute__((target("avx2")))
+inline __m256i loadLanes(const uchar* low, const uchar* high) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(high)), 1);
+}
+
+__attribute__((target("avx2")))
+void interpolateRowAVX2(const uchar* src, const AxisTable& cols, const ShuffleTable& shuffle, int channels, uint16_t* out) {
+    int groups = static_cast<int>(shuffle.base.size()) / 2;
+    const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+    int g = 0;
+    for (; g + 2 <= groups; g += 2) {
+        const int* base = &shuffle.base[2 * g];
+        if (base[0] < 0 || base[2] < 0) {
+            for (int k = g; k < g + 2; ++k) {
+                if (shuffle.base[2 * k] < 0) interpolateValues(src, cols, channels, k * SHUFFLE_GROUP, (k + 1) * SHUFFLE_GROUP, out);
+                else interpolateGroupSSSE3(src, shuffle, k, out);
+            }
+            continue;
+        }
+        const uchar* mask = &shuffle.mask[32 * g];
+        __m256i left = _mm256_shuffle_epi8(loadLanes(src + base[0], src + base[2]), loadLanes(mask, mask + 32));
+        __m256i right = _mm256_shuffle_epi8(loadLanes(src + base[1], src + base[3]), loadLanes(mask + 16, mask + 48));
+        __m256i pairs = _mm256_or_si256(left, right);
+        __m256i first = _mm256_and_si256(pairs, lowBytes);
+        __m256i second = _mm256_srli_epi16(pairs, 8);
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&shuffle.weight[g * SHUFFLE_GROUP]));
+        __m256i value = _mm256_add_epi16(_mm256_slli_epi16(first, 8), _mm256_mullo_epi16(_mm256_sub_epi16(second, first), weight));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + g * SHUFFLE_GROUP), value);
+    }
+    for (; g < groups; ++g) {
+        if (shuffle.base[2 * g] < 0) interpolateValues(src, cols, channels, g * SHUFFLE_GROUP, (g + 1) * SHUFFLE_GROUP, out);
+        else interpolateGroupSSSE3(src, shuffle, g, out);
+    }
+    interpolateValues(src, cols, channels, groups * SHUFFLE_GROUP, static_cast<int>(shuffle.weight.size()), out);
+}
+#endif
+
+// Elige una vez la mejor versión disponible en la CPU
+BlendRowsFn selectBlendRows() {
+#ifdef IMAGE_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) return blendRowsAVX2;
+    if (__builtin_cpu_supports("sse2")) return blendRowsSSE2;
+#endif
+    return blendRowsScalar;
+}
+
+// pshufb necesita SSSE3; en una CPU con solo SSE2 la pasada horizontal queda escalar
+InterpolateRowFn selectInterpolateRow() {
+#ifdef IMAGE_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) return interpolateRowAVX2;
+    if (__builtin_cpu_supports("ssse3")) return interpolateRowSSSE3;
+#endif
+    return interpolateRowScalar;
+}
+
+// Punto fijo con 32 bits de fracción para las coordenadas de rotación
+const int FIXED_BITS = 32;
+
+int64_t toFixed(double value) {
+    return static_cast<int64_t>(std::llround(value * static_cast<double>(int64_t(1) << FIXED_BITS)));
+}
+
+int64_t floorDiv(int64_t a, int64_t b) {  // b > 0
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Rango [first, last) de enteros n con 0 <= base + n * step < limit (puede quedar vacío)
+void linearRange(int64_t base, int64_t step, int64_t limit, int64_t& first, int64_t& last) {
+    if (step == 0) {
+        bool inside = base >= 0 && base < limit;
+        first = inside ? INT64_MIN / 2 : 0;
+        last = inside ? INT64_MAX / 2 : 0;
+    } else if (step > 0) {
+        first = floorDiv(-base + step - 1, step);          // techo(-base / step)
+        last = floorDiv(limit - base + step - 1, step);    // techo((limit - base) / step)
+    } else {
+        first = floorDiv(base - limit, -step) + 1;
+        last = floorDiv(base, -step) + 1;
+    }
+}
+
+// Parte de [start, end) donde las dos coordenadas de origen caen dentro de la imagen
+void validSpan(int64_t baseX, int64_t stepX, int64_t limitX,
+               int64_t baseY, int64_t stepY, int64_t limitY,
+               int start, int end, int& spanStart, int& spanEnd) {
+    int64_t firstX, lastX, firstY, lastY;
+    linearRange(baseX, stepX, limitX, firstX, lastX);
+    linearRange(baseY, stepY, limitY, firstY, lastY);
+
+    int64_t first = std::max<int64_t>(start, std::max(firstX, firstY));
+    int64_t last = std::min<int64_t>(end, std::min(lastX, lastY));
+    spanStart = static_cast<int>(std::min<int64_t>(first, end));
+    spanEnd = static_cast<int>(std::max<int64_t>(last, spanStart));
+}
+
+} // namespace
+
+ImageProcessor::ImageProcessor(int threads) : threads(threads) {
+    if (threads != 1) {
+        // OpenCV usa su propio pool de hilos; un valor negativo lo deja con todos los núcleos
+        cv::setNumThreads(threads > 0 ? threads : -1);
+    }
+}
 
 cv::Mat ImageProcessor::loadImage(const std::string& filepath) {
     cv::Mat image = cv::imread(filepath);
@@ -15,38 +336,7 @@ cv::Mat ImageProcessor::scaleImage(const cv::Mat& image, double scaleFactor) {
     int newCols = static_cast<int>(image.cols * scaleFactor);
     cv::Mat scaledImage(newRows, newCols, image.type());
 
-    for (int y = 0; y < newRows; ++y) {
-        for (int x = 0; x < newCols; ++x) {
-            float srcX = x / scaleFactor;
-            float srcY = y / scaleFactor;
-
-            int x1 = static_cast<int>(srcX);
-            int y1 = static_cast<int>(srcY);
-            int x2 = std::min(x1 + 1, image.cols - 1);
-            int y2 = std::min(y1 + 1, image.rows - 1);
-
-            float dx = srcX - x1;
-            float dy = srcY - y1;
-
-            cv::Vec3b p1 = image.at<cv::Vec3b>(y1, x1);
-            cv::Vec3b p2 = image.at<cv::Vec3b>(y1, x2);
-            cv::Vec3b p3 = image.at<cv::Vec3b>(y2, x1);
-            cv::Vec3b p4 = image.at<cv::Vec3b>(y2, x2);
-
-            cv::Vec3b interpolatedPixel;
-            for (int c = 0; c < 3; ++c) {
-                float interpolatedValue =
-                    (1 - dx) * (1 - dy) * p1[c] +
-                    dx * (1 - dy) * p2[c] +
-                    (1 - dx) * dy * p3[c] +
-                    dx * dy * p4[c];
-
-                interpolatedPixel[c] = static_cast<uchar>(interpolatedValue);
-            }
-
-            scaledImage.at<cv::Vec3b>(y, x) = interpolatedPixel;
-        }
-    }
+    resizeBilinear(image, scaledImage, scaleFactor);
 
     return scaledImage;
 }
@@ -57,37 +347,44 @@ void ImageProcessor::scaleImageToBuddy(const cv::Mat& src, cv::Mat& dst, double
     
     CV_Assert(dst.rows == newRows && dst.cols == newCols && dst.type() == src.type());
 
-    for (int y = 0; y < newRows; ++y) {
-        for (int x = 0; x < newCols; ++x) {
-            float srcX = x / scaleFactor;
-            float srcY = y / scaleFactor;
-
-            int x1 = static_cast<int>(srcX);
-            int y1 = static_cast<int>(srcY);
-            int x2 = std::min(x1 + 1, src.cols - 1);
-            int y2 = std::min(y1 + 1, src.rows - 1);
-
-            float dx = srcX - x1;
-            float dy = srcY - y1;
-
-            cv::Vec3b p1 = src.at<cv::Vec3b>(y1, x1);
-            cv::Vec3b p2 = src.at<cv::Vec3b>(y1, x2);
-            cv::Vec3b p3 = src.at<cv::Vec3b>(y2, x1);
-            cv::Vec3b p4 = src.at<cv::Vec3b>(y2, x2);
-
-            cv::Vec3b interpolatedPixel;
-            for (int c = 0; c < 3; ++c) {
-                float interpolatedValue =
-                    (1 - dx) * (1 - dy) * p1[c] +
-                    dx * (1 - dy) * p2[c] +
-                    (1 - dx) * dy * p3[c] +
-                    dx * dy * p4[c];
-
-                interpolatedPixel[c] = static_cast<uchar>(interpolatedValue);
-            }
+    resizeBilinear(src, dst, scaleFactor);
+}
 
-            dst.at<cv::Vec3b>(y, x) = interpolatedPixel;
+// Escalado bilineal separable: las posiciones y pesos de cada columna y fila se calculan una vez,
+// cada fila de origen se interpola en horizontal una sola vez y las dos pasadas usan SIMD.
+void ImageProcessor::resizeBilinear(const cv::Mat& src, cv::Mat& dst, double scaleFactor) {
+    static const BlendRowsFn blendRows = selectBlendRows();
+    static const InterpolateRowFn interpolateRow = selectInterpolateRow();
+
+    int channels = src.channels();
+    int rowValues = dst.cols * channels;
+    AxisTable colTable = buildAxisTable(dst.cols, src.cols, scaleFactor, channels);
+    AxisTable rowTable = buildAxisTable(dst.rows, src.rows, scaleFactor, 1);
+    ShuffleTable shuffle = buildShuffleTable(colTable, channels, src.cols * channels);
+
+    // Caché de las dos últimas filas de origen ya interpoladas en horizontal
+    std::vector<uint16_t> cached[2] = { std::vector<uint16_t>(rowValues), std::vector<uint16_t>(rowValues) };
+    int cachedRow[2] = { -1, -1 };
+
+    auto horizontalRow = [&](int srcRow, int keepRow) -> const uint16_t* {
+        for (int k = 0; k < 2; ++k) {
+            if (cachedRow[k] == srcRow) return cached[k].data();
         }
+        int slot = (cachedRow[0] == keepRow) ? 1 : 0;
+        interpolateRow(src.ptr<uchar>(srcRow), colTable, shuffle, channels, cached[slot].data());
+        cachedRow[slot] = srcRow;
+        return cached[slot].data();
+    };
+
+    for (int y = 0; y < dst.rows; ++y) {
+        // Con peso 0 o 256 una de las dos filas no aporta nada y no hace falta interpolarla
+        // (al reducir a la mitad, por ejemplo, todas las filas caen justo sobre una de origen)
+        unsigned wy = rowTable.weight[y];
+        int y1 = wy == 256 ? rowTable.second[y] : rowTable.first[y];
+        int y2 = wy == 0 ? rowTable.first[y] : rowTable.second[y];
+        const uint16_t* top = horizontalRow(y1, y2);
+        const uint16_t* bottom = horizontalRow(y2, y1);
+        blendRows(top, bottom, wy, dst.ptr<uchar>(y), rowValues);
     }
 }
 
@@ -132,31 +429,11 @@ cv::Mat ImageProcessor::rotateImage(const cv::Mat& image, double angle) {
     // Crear imagen de destino
     cv::Mat rotatedImage(static_cast<int>(new_height), static_cast<int>(new_width), image.type());
 
-    // Centro de la imagen original y nueva
-    double original_center_x = image.cols / 2.0;
-    double original_center_y = image.rows / 2.0;
+    // Centro de la imagen nueva
     double new_center_x = new_width / 2.0;
     double new_center_y = new_height / 2.0;
 
-    for (int y = 0; y < rotatedImage.rows; ++y) {
-        for (int x = 0; x < rotatedImage.cols; ++x) {
-            // Convertir coordenadas al sistema centrado
-            double x_offset = x - new_center_x;
-            double y_offset = y - new_center_y;
-
-            // Rotación inversa (de destino a origen)
-            double original_x = x_offset * cos_theta + y_offset * sin_theta + original_center_x;
-            double original_y = -x_offset * sin_theta + y_offset * cos_theta + original_center_y;
-
-            // Si el punto está dentro de la imagen original
-            if (original_x >= 0 && original_x < image.cols && original_y >= 0 && original_y < image.rows) {
-                rotatedImage.at<cv::Vec3b>(y, x) = bilinearInterpolate(image, original_x, original_y);
-            } else {
-                // Poner negro si está fuera de los límites
-                rotatedImage.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 0, 0);
-            }
-        }
-    }
+    rotateTiles(image, rotatedImage, cos_theta, sin_theta, new_center_x, new_center_y);
 
     return rotatedImage;
 }
@@ -167,29 +444,88 @@ void ImageProcessor::rotateImageToBuddy(const cv::Mat& src, cv::Mat& dst, double
     double cos_theta = cos(radians);
     double sin_theta = sin(radians);
 
-    // Centro de la imagen original y nueva
-    double original_center_x = src.cols / 2.0;
-    double original_center_y = src.rows / 2.0;
+    // Centro de la imagen nueva
     double new_center_x = dst.cols / 2.0;
     double new_center_y = dst.rows / 2.0;
 
-    for (int y = 0; y < dst.rows; ++y) {
-        for (int x = 0; x < dst.cols; ++x) {
-            // Convertir coordenadas al sistema centrado
-            double x_offset = x - new_center_x;
-            double y_offset = y - new_center_y;
-
-            // Rotación inversa (de destino a origen)
-            double original_x = x_offset * cos_theta + y_offset * sin_theta + original_center_x;
-            double original_y = -x_offset * sin_theta + y_offset * cos_theta + original_center_y;
-
-            // Si el punto está dentro de la imagen original
-            if (original_x >= 0 && original_x < src.cols && original_y >= 0 && original_y < src.rows) {
-                dst.at<cv::Vec3b>(y, x) = bilinearInterpolate(src, original_x, original_y);
-            } else {
-                // Poner negro si está fuera de los límites
-                dst.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 0, 0);
+    rotateTiles(src, dst, cos_theta, sin_theta, new_center_x, new_center_y);
+}
+
+// Rotación inversa (de destino a origen) recorriendo el destino por tiles.
+// Las coordenadas de origen avanzan en punto fijo sumando un paso por pixel; el tramo de cada fila que cae
+// dentro de la imagen se calcula de forma analítica, así el bucle interno no compara límites y lo de fuera
+// se rellena con memset. Al ser aritmética entera, el modo secuencial y el paralelo dan el mismo resultado.
+void ImageProcessor::rotateTiles(const cv::Mat& src, cv::Mat& dst, double cos_theta, double sin_theta,
+                                 double new_center_x, double new_center_y) {
+    double original_center_x = src.cols / 2.0;
+    double original_center_y = src.rows / 2.0;
+
+    // original_x(x, y) = baseX + x * stepXx + y * stepXy ; original_y(x, y) = baseY + x * stepYx + y * stepYy
+    const int64_t stepXx = toFixed(cos_theta), stepXy = toFixed(sin_theta);
+    const int64_t stepYx = toFixed(-sin_theta), stepYy = toFixed(cos_theta);
+    // Medio paso de la rejilla de pesos (1/512 px): truncar equivale a redondear al peso más cercano
+    const int64_t halfWeight = int64_t(1) << (FIXED_BITS - 9);
+    const int64_t baseX = toFixed(original_center_x - new_center_x * cos_theta - new_center_y * sin_theta) + halfWeight;
+    const int64_t baseY = toFixed(original_center_y + new_center_x * sin_theta - new_center_y * cos_theta) + halfWeight;
+    const int64_t limitX = int64_t(src.cols) << FIXED_BITS;
+    const int64_t limitY = int64_t(src.rows) << FIXED_BITS;
+
+    int tilesX = (dst.cols + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (dst.rows + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t pixelSize = sizeof(cv::Vec3b);
+
+    auto rotateTile = [&](int tile) {
+        int startX = (tile % tilesX) * TILE_SIZE;
+        int startY = (tile / tilesX) * TILE_SIZE;
+        int endX = std::min(startX + TILE_SIZE, dst.cols);
+        int endY = std::min(startY + TILE_SIZE, dst.rows);
+
+        for (int y = startY; y < endY; ++y) {
+            uchar* row = dst.ptr<uchar>(y);
+            int64_t rowX = baseX + y * stepXy;
+            int64_t rowY = baseY + y * stepYy;
+
+            int spanStart, spanEnd;
+            validSpan(rowX, stepXx, limitX, rowY, stepYx, limitY, startX, endX, spanStart, spanEnd);
+
+            // Poner negro lo que queda fuera de la imagen original
+            memset(row + startX * pixelSize, 0, (spanStart - startX) * pixelSize);
+            memset(row + spanEnd * pixelSize, 0, (endX - spanEnd) * pixelSize);
+
+            int64_t fx = rowX + spanStart * stepXx;
+            int64_t fy = rowY + spanStart * stepYx;
+            for (int x = spanStart; x < spanEnd; ++x) {
+                int x1 = static_cast<int>(fx >> FIXED_BITS);
+                int y1 = static_cast<int>(fy >> FIXED_BITS);
+                int x2 = std::min(x1 + 1, src.cols - 1);
+                int y2 = std::min(y1 + 1, src.rows - 1);
+                unsigned dx = static_cast<unsigned>(fx >> (FIXED_BITS - 8)) & 0xFF;
+                unsigned dy = static_cast<unsigned>(fy >> (FIXED_BITS - 8)) & 0xFF;
+
+                const uchar* p1 = src.ptr<uchar>(y1) + x1 * pixelSize;
+                const uchar* p2 = src.ptr<uchar>(y1) + x2 * pixelSize;
+                const uchar* p3 = src.ptr<uchar>(y2) + x1 * pixelSize;
+                const uchar* p4 = src.ptr<uchar>(y2) + x2 * pixelSize;
+                uchar* out = row + x * pixelSize;
+
+                for (int c = 0; c < 3; ++c) {
+                    unsigned top = p1[c] * (256 - dx) + p2[c] * dx;
+                    unsigned bottom = p3[c] * (256 - dx) + p4[c] * dx;
+                    out[c] = static_cast<uchar>((top * (256 - dy) + bottom * dy) >> 16);
+                }
+
+                fx += stepXx;
+                fy += stepYx;
             }
         }
+    };
+
+    int totalTiles = tilesX * tilesY;
+    if (threads == 1) {
+        for (int tile = 0; tile < totalTiles; ++tile) rotateTile(tile);
+    } else {
+        cv::parallel_for_(cv::Range(0, totalTiles), [&](const cv::Range& range) {
+            for (int tile = range.start; tile < range.end; ++tile) rotateTile(tile);
+        });
     }
 }
\ No newline at end of file
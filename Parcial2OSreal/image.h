@@ -8,6 +8,9 @@
 
 class ImageProcessor {
 public:
+    // threads: 1 = secuencial, 0 = todos los núcleos, N = N hilos (pool de OpenCV)
+    explicit ImageProcessor(int threads = 1);
+
     cv::Mat loadImage(const std::string& filepath);
     cv::Mat scaleImage(const cv::Mat& image, double scaleFactor);
     void scaleImageToBuddy(const cv::Mat& src, cv::Mat& dst, double scaleFactor);
@@ -16,7 +19,12 @@ public:
     cv::Vec3b bilinearInterpolate(const cv::Mat& img, float x, float y);
     
 private:
-    
+    static const int TILE_SIZE = 64; // Lado en píxeles de los tiles de rotación
+    int threads;
+
+    void resizeBilinear(const cv::Mat& src, cv::Mat& dst, double scaleFactor);
+    void rotateTiles(const cv::Mat& src, cv::Mat& dst, double cos_theta, double sin_theta,
+                     double new_center_x, double new_center_y);
 };
 
 #endif // IMAGE_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <chrono>
 #include <sys/resource.h>
+#include <vector>
 
 using namespace std;
 using namespace cv;
@@ -34,20 +35,32 @@ void buddyDeallocate(Mat& mat) {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 6) {
-        cerr << "Uso: " << argv[0] << " <imagen_entrada> <imagen_salida> <-rotar/-escalar> <factor> <buddy_system (0/1)>" << endl;
+    // Separar la opción --threads de los argumentos posicionales
+    vector<char*> args;
+    int threads = 1;
+    for (int i = 0; i < argc; i++) {
+        if (string(argv[i]) == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (args.size() != 6 || threads < 0) {
+        cerr << "Uso: " << argv[0] << " <imagen_entrada> <imagen_salida> <-rotar/-escalar> <factor> <buddy_system (0/1)> [--threads N]" << endl;
         cerr << "Ejemplo para escalar: " << argv[0] << " input.jpg output.jpg -escalar 1.5 1" << endl;
         cerr << "Ejemplo para rotar: " << argv[0] << " input.jpg output.jpg -rotar 45 0" << endl;
+        cerr << "Rotación en paralelo: " << argv[0] << " input.jpg output.jpg -rotar 45 0 --threads 8 (0 = todos los núcleos)" << endl;
         return 1;
     }
 
-    string inputFile = argv[1];
-    string outputFile = argv[2];
-    string operation = argv[3];
-    double factor = atof(argv[4]);
-    bool useBuddySystem = atoi(argv[5]);
+    string inputFile = args[1];
+    string outputFile = args[2];
+    string operation = args[3];
+    double factor = atof(args[4]);
+    bool useBuddySystem = atoi(args[5]);
 
-    ImageProcessor processor;
+    ImageProcessor processor(threads);
     Mat image = processor.loadImage(inputFile);
 
     cout << "\n=== Estado inicial ===" << endl;
@@ -136,7 +149,8 @@ int main(int argc, char* argv[]) {
 
     size_t memFinal = getMemoryUsage();
     cout << "\n=== Resumen final ===" << endl;
-    cout << "Tiempo de ejecución: " << elapsed.count() << " segundos" << endl;
+    cout << "Tiempo de ejecución: " << elapsed.count() << " segundos";
+    cout << " (" << (threads == 0 ? getNumThreads() : threads) << " hilo(s))" << endl;
     cout << "Memoria del sistema al final: " << memFinal << " KB" << endl;
     cout << "Memoria total utilizada: " << (memFinal - memBefore) << " KB" << endl;
 
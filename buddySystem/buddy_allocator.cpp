@@ -4,14 +4,42 @@
 
 using namespace std;
 
-// Constructor: asigna un bloque de memoria de tamaño especificado usando malloc.
-BuddyAllocator::BuddyAllocator(size_t size) {
-    this->size = size;
-    memoriaBase = std::malloc(size);
-    if (!memoriaBase) {
+const size_t BuddyAllocator::ALINEACION_CACHE;
+const size_t BuddyAllocator::ALINEACION_PAGINA;
+
+static const unsigned char SIN_ASIGNAR = 0xFF;
+
+// Redondea n a la siguiente potencia de 2
+static size_t siguientePotenciaDe2(size_t n) {
+    size_t potencia = 1;
+    while (potencia < n) potencia <<= 1;
+    return potencia;
+}
+
+static unsigned log2Exacto(size_t n) {
+    unsigned k = 0;
+    while ((size_t(1) << k) < n) k++;
+    return k;
+}
+
+// Constructor: reserva la memoria base alineada y la deja como un único bloque libre.
+BuddyAllocator::BuddyAllocator(size_t size, size_t alineacion) : usada(0) {
+    // El bloque mínimo debe poder guardar los enlaces de la lista libre
+    size_t bloqueMinimo = siguientePotenciaDe2(alineacion < sizeof(NodoLibre) ? sizeof(NodoLibre) : alineacion);
+    this->size = siguientePotenciaDe2(size < bloqueMinimo ? bloqueMinimo : size);
+    desplazamientoMinimo = log2Exacto(bloqueMinimo);
+    ordenMaximo = log2Exacto(this->size) - desplazamientoMinimo;
+
+    if (posix_memalign(&memoriaBase, bloqueMinimo < sizeof(void*) ? sizeof(void*) : bloqueMinimo, this->size) != 0) {
         cerr << "Error: No se pudo asignar memoria base con Buddy System.\n";
         exit(1);
     }
+
+    listasLibres.assign(ordenMaximo + 1, nullptr);
+    nodosLibres.assign(((size_t(2) << ordenMaximo) + 63) / 64, 0);
+    ordenes.assign(this->size >> desplazamientoMinimo, SIN_ASIGNAR);
+
+    insertarLibre(0, ordenMaximo);
 }
 
 // Destructor: libera el bloque de memoria.
@@ -19,19 +47,86 @@ BuddyAllocator::~BuddyAllocator() {
     std::free(memoriaBase);
 }
 
+// Número del nodo (desplazamiento, orden) en el árbol implícito; la raíz es el nodo 1
+size_t BuddyAllocator::nodo(size_t desplazamiento, unsigned orden) const {
+    return (size_t(1) << (ordenMaximo - orden)) + (desplazamiento >> (orden + desplazamientoMinimo));
+}
+
+bool BuddyAllocator::estaLibre(size_t n) const {
+    return (nodosLibres[n >> 6] >> (n & 63)) & 1;
+}
+
+void BuddyAllocator::marcarLibre(size_t n, bool libre) {
+    if (libre) nodosLibres[n >> 6] |= uint64_t(1) << (n & 63);
+    else       nodosLibres[n >> 6] &= ~(uint64_t(1) << (n & 63));
+}
+
+void BuddyAllocator::insertarLibre(size_t desplazamiento, unsigned orden) {
+    NodoLibre* bloque = reinterpret_cast<NodoLibre*>(static_cast<char*>(memoriaBase) + desplazamiento);
+    bloque->anterior = nullptr;
+    bloque->siguiente = listasLibres[orden];
+    if (bloque->siguiente) bloque->siguiente->anterior = bloque;
+    listasLibres[orden] = bloque;
+    marcarLibre(nodo(desplazamiento, orden), true);
+}
+
+void BuddyAllocator::quitarLibre(size_t desplazamiento, unsigned orden) {
+    NodoLibre* bloque = reinterpret_cast<NodoLibre*>(static_cast<char*>(memoriaBase) + desplazamiento);
+    if (bloque->anterior) bloque->anterior->siguiente = bloque->siguiente;
+    else listasLibres[orden] = bloque->siguiente;
+    if (bloque->siguiente) bloque->siguiente->anterior = bloque->anterior;
+    marcarLibre(nodo(desplazamiento, orden), false);
+}
+
 // Asigna un bloque de memoria del tamaño especificado.
-// Si el tamaño solicitado supera el bloque disponible, devuelve nullptr.
+// Si no hay un bloque libre suficientemente grande, devuelve nullptr.
 void* BuddyAllocator::alloc(size_t size) {
     if (size > this->size) {
-        cerr << "Error: Tamaño solicitado (" << size 
-             << " bytes) supera el tamaño disponible (" 
+        cerr << "Error: Tamaño solicitado (" << size
+             << " bytes) supera el tamaño disponible ("
              << this->size << " bytes).\n";
         return nullptr;
     }
-    return memoriaBase;
+
+    unsigned orden = 0;
+    while ((size_t(1) << (orden + desplazamientoMinimo)) < size) orden++;
+
+    // Lista libre no vacía más pequeña que sirva
+    unsigned actual = orden;
+    while (actual <= ordenMaximo && !listasLibres[actual]) actual++;
+    if (actual > ordenMaximo) return nullptr;
+
+    size_t desplazamiento = reinterpret_cast<char*>(listasLibres[actual]) - static_cast<char*>(memoriaBase);
+    quitarLibre(desplazamiento, actual);
+
+    // Dividir hasta el orden pedido; la mitad derecha de cada división queda libre
+    while (actual > orden) {
+        actual--;
+        insertarLibre(desplazamiento + (size_t(1) << (actual + desplazamientoMinimo)), actual);
+    }
+
+    ordenes[desplazamiento >> desplazamientoMinimo] = static_cast<unsigned char>(orden);
+    usada += size_t(1) << (orden + desplazamientoMinimo);
+    return static_cast<char*>(memoriaBase) + desplazamiento;
 }
 
-// Libera el bloque de memoria (sin efecto en esta implementación).
+// Libera el bloque y lo fusiona con su buddy mientras sea posible.
 void BuddyAllocator::free(void* ptr) {
-    // No liberamos porque el Buddy System maneja esto automáticamente.
+    if (!ptr || !contiene(ptr)) return;
+
+    size_t desplazamiento = static_cast<char*>(ptr) - static_cast<char*>(memoriaBase);
+    unsigned char orden = ordenes[desplazamiento >> desplazamientoMinimo];
+    if (orden == SIN_ASIGNAR) return;  // No es el inicio de un bloque asignado
+
+    ordenes[desplazamiento >> desplazamientoMinimo] = SIN_ASIGNAR;
+    usada -= size_t(1) << (orden + desplazamientoMinimo);
+
+    while (orden < ordenMaximo) {
+        size_t buddy = desplazamiento ^ (size_t(1) << (orden + desplazamientoMinimo));
+        if (!estaLibre(nodo(buddy, orden))) break;
+        quitarLibre(buddy, orden);
+        if (buddy < desplazamiento) desplazamiento = buddy;
+        orden++;
+    }
+    insertarLibre(desplazamiento, orden);
 }
@@ -2,24 +2,61 @@
 #define BUDDY_ALLOCATOR_H
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 class BuddyAllocator {
 public:
-    // Constructor: asigna un bloque de memoria de tamaño especificado.
-    BuddyAllocator(size_t size);
+    // Alineaciones típicas para el tamaño mínimo de bloque
+    static const size_t ALINEACION_CACHE = 64;
+    static const size_t ALINEACION_PAGINA = 4096;
+
+    // Constructor: asigna un bloque de memoria de tamaño especificado (redondeado a potencia de 2).
+    // Todo bloque entregado por alloc() queda alineado al menos a 'alineacion' bytes.
+    BuddyAllocator(size_t size, size_t alineacion = ALINEACION_CACHE);
 
     // Destructor: libera el bloque de memoria.
     ~BuddyAllocator();
 
-    // Asigna un bloque de memoria del tamaño solicitado.
+    // Asigna un bloque de memoria del tamaño solicitado, dividiendo bloques libres si hace falta.
+    // Devuelve nullptr si no hay un bloque libre suficientemente grande.
     void* alloc(size_t size);
 
-    // Libera el bloque de memoria (sin efecto en esta implementación).
+    // Libera el bloque y lo fusiona con su buddy mientras este también esté libre.
     void free(void* ptr);
 
+    size_t memoriaTotal() const { return size; }
+    size_t memoriaUsada() const { return usada; }
+
+    // true si ptr apunta dentro de la memoria gestionada por este allocator
+    bool contiene(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        const char* base = static_cast<const char*>(memoriaBase);
+        return p >= base && p < base + size;
+    }
+
 private:
+    // Enlaces de la lista libre, guardados dentro del propio bloque libre
+    struct NodoLibre {
+        NodoLibre* anterior;
+        NodoLibre* siguiente;
+    };
+
     size_t size;         // Tamaño total de la memoria gestionada
     void* memoriaBase;   // Puntero al bloque de memoria base
+    size_t usada;        // Bytes entregados actualmente (incluye el redondeo)
+    unsigned desplazamientoMinimo;  // log2 del bloque mínimo
+    unsigned ordenMaximo;           // size == bloque mínimo << ordenMaximo
+
+    std::vector<NodoLibre*> listasLibres;   // Una lista libre por orden
+    std::vector<uint64_t> nodosLibres;      // Bitmap: nodo del árbol buddy -> está en una lista libre
+    std::vector<unsigned char> ordenes;     // Orden de cada bloque asignado, por bloque mínimo
+
+    size_t nodo(size_t desplazamiento, unsigned orden) const;
+    bool estaLibre(size_t nodo) const;
+    void marcarLibre(size_t nodo, bool libre);
+    void insertarLibre(size_t desplazamiento, unsigned orden);
+    void quitarLibre(size_t desplazamiento, unsigned orden);
 };
 
 #endif
@@ -1,52 +1,65 @@
 #include "imagen.h"
 #include "stb_image.h"
 #include "stb_image_write.h"
+#include "stb_wrapper.h"
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 using namespace std;
 
+const size_t Imagen::ALINEACION;
+const int Imagen::TAM_TILE;
+
 
 // ✅ Implementación del constructor
+// La imagen adopta el buffer decodificado por stb: filas empaquetadas (paso = ancho * canales),
+// reservado por los hooks de stb_wrapper directamente en la arena cuando hay allocador.
 Imagen::Imagen(const std::string &nombreArchivo, BuddyAllocator *allocador)
-    : allocador(allocador) {
+    : paso(0), pixeles(nullptr), allocador(allocador) {
+
+    stbUsarAllocador(allocador);
+    pixeles = stbi_load(nombreArchivo.c_str(), &ancho, &alto, &canales, 0);
+    stbUsarAllocador(nullptr);
 
-    unsigned char* buffer = stbi_load(nombreArchivo.c_str(), &ancho, &alto, &canales, 0);
-    if (!buffer) {
+    if (!pixeles) {
         cerr << "Error: No se pudo cargar la imagen '" << nombreArchivo << "'.\n";
         exit(1);
     }
-
-    convertirBufferAMatriz(buffer);
-    stbi_image_free(buffer);
+    paso = static_cast<size_t>(ancho) * canales;
 }
 
 // ✅ Implementación del destructor
 Imagen::~Imagen() {
-    if (!allocador) {
-        for (int y = 0; y < alto; y++) {
-            for (int x = 0; x < ancho; x++) {
-                delete[] pixeles[y][x];
-            }
-            delete[] pixeles[y];
-        }
-        delete[] pixeles;
-    }
+    liberarPixeles(pixeles);
 }
 
-// ✅ Implementación de convertirBufferAMatriz()
-void Imagen::convertirBufferAMatriz(unsigned char* buffer) {
-    int indice = 0;
-    pixeles = new unsigned char**[alto];
+// Reserva un buffer contiguo de alto filas, cada una rellenada hasta un múltiplo de ALINEACION.
+// Con allocador se usa la arena del Buddy System; si no hay espacio se recurre al heap.
+unsigned char* Imagen::reservarPixeles(int alto, int ancho, size_t &paso) {
+    size_t bytesFila = static_cast<size_t>(ancho) * canales;
+    paso = (bytesFila + ALINEACION - 1) / ALINEACION * ALINEACION;
+    size_t total = paso * alto;
 
-    for (int y = 0; y < alto; y++) {
-        pixeles[y] = new unsigned char*[ancho];
-        for (int x = 0; x < ancho; x++) {
-            pixeles[y][x] = new unsigned char[canales];
-            for (int c = 0; c < canales; c++) {
-                pixeles[y][x][c] = buffer[indice++];
-            }
-        }
+    if (allocador) {
+        void* memoria = allocador->alloc(total);
+        if (memoria) return static_cast<unsigned char*>(memoria);
+        cerr << "[AVISO] Buddy System sin espacio, usando el heap para " << total << " bytes.\n";
     }
+
+    void* memoria = nullptr;
+    if (posix_memalign(&memoria, ALINEACION, total ? total : ALINEACION) != 0) {
+        cerr << "Error: No se pudo reservar memoria para la imagen.\n";
+        exit(1);
+    }
+    return static_cast<unsigned char*>(memoria);
+}
+
+// Sirve tanto para buffers propios como para los adoptados de stb
+void Imagen::liberarPixeles(unsigned char *buffer) {
+    liberarBufferStb(buffer, allocador);
 }
 
 // ✅ Implementación de mostrarInfo()
@@ -55,154 +68,203 @@ void Imagen::mostrarInfo() const {
     cout << "Canales: " << canales << endl;
 }
 
-// ✅ Implementación de guardarImagen()
+// ✅ Implementación de guardarImagen(): stb acepta el paso entre filas, no hace falta copiar
 void Imagen::guardarImagen(const std::string &nombreArchivo) const {
-    unsigned char* buffer = new unsigned char[alto * ancho * canales];
-    int indice = 0;
-
-    for (int y = 0; y < alto; y++) {
-        for (int x = 0; x < ancho; x++) {
-            for (int c = 0; c < canales; c++) {
-                buffer[indice++] = pixeles[y][x][c];
-            }
-        }
-    }
-    // Guardar la imagen en formato PNG, el tercer parametro es el número de canales
-    // 0 para PNG, 1 para JPEG, 2 para BMP, etc.
-    if (!stbi_write_png(nombreArchivo.c_str(), ancho, alto, canales, buffer, ancho * canales)) {
+    // Guardar la imagen en formato PNG, el último parámetro es el paso en bytes entre filas
+    if (!stbi_write_png(nombreArchivo.c_str(), ancho, alto, canales, pixeles, static_cast<int>(paso))) {
         cerr << "Error: No se pudo guardar la imagen en '" << nombreArchivo << "'.\n";
-        delete[] buffer;
         exit(1);
     }
 
-    delete[] buffer;
     cout << "[INFO] Imagen guardada correctamente en '" << nombreArchivo << "'.\n";
 }
 
 // ✅ Implementación para invertir los colores.
 void Imagen::invertirColores() {
+    size_t bytesFila = static_cast<size_t>(ancho) * canales;
     for (int y = 0; y < alto; y++) {
-        for (int x = 0; x < ancho; x++) {
-            for (int c = 0; c < canales; c++) {
-                pixeles[y][x][c] = 255 - pixeles[y][x][c];
-            }
-        }
-    }}
-
-
-    // ✅ Implementación para convertir a escala de grises.
-    void Imagen::escalarImagen(float factor=0.5) {
-        int nuevoAncho = static_cast<int>(ancho * factor);
-        int nuevoAlto = static_cast<int>(alto * factor);
-        unsigned char*** nuevaMatriz = new unsigned char**[nuevoAlto];
-    
-        for (int y = 0; y < nuevoAlto; y++) {
-            nuevaMatriz[y] = new unsigned char*[nuevoAncho];
-            for (int x = 0; x < nuevoAncho; x++) {
-                nuevaMatriz[y][x] = new unsigned char[canales];
-                
-                float srcX = x / factor;
-                float srcY = y / factor;
-                int x0 = static_cast<int>(srcX);
-                int y0 = static_cast<int>(srcY);
-                int x1 = min(x0 + 1, ancho - 1);
-                int y1 = min(y0 + 1, alto - 1);
-    
-                float dx = srcX - x0;
-                float dy = srcY - y0;
-    
-                for (int c = 0; c < canales; c++) {
-                    float valor = (1 - dx) * (1 - dy) * pixeles[y0][x0][c] +
-                                  dx * (1 - dy) * pixeles[y0][x1][c] +
-                                  (1 - dx) * dy * pixeles[y1][x0][c] +
-                                  dx * dy * pixeles[y1][x1][c];
-                    nuevaMatriz[y][x][c] = static_cast<unsigned char>(valor);
-                }
-            }
+        unsigned char* p = fila(y);
+        for (size_t i = 0; i < bytesFila; i++) {
+            p[i] = 255 - p[i];
         }
-    
-        // Liberar la memoria de la imagen original
-        for (int y = 0; y < alto; y++) {
-            for (int x = 0; x < ancho; x++) {
-                delete[] pixeles[y][x];
+    }
+}
+
+// ✅ Implementación para escalar la imagen con interpolación bilineal.
+void Imagen::escalarImagen(float factor=0.5) {
+    int nuevoAncho = static_cast<int>(ancho * factor);
+    int nuevoAlto = static_cast<int>(alto * factor);
+
+    size_t nuevoPaso;
+    unsigned char* nuevosPixeles = reservarPixeles(nuevoAlto, nuevoAncho, nuevoPaso);
+
+    for (int y = 0; y < nuevoAlto; y++) {
+        float srcY = y / factor;
+        int y0 = static_cast<int>(srcY);
+        int y1 = min(y0 + 1, alto - 1);
+        float dy = srcY - y0;
+        const unsigned char* fila0 = fila(y0);
+        const unsigned char* fila1 = fila(y1);
+        unsigned char* destino = nuevosPixeles + y * nuevoPaso;
+
+        for (int x = 0; x < nuevoAncho; x++) {
+            float srcX = x / factor;
+            int x0 = static_cast<int>(srcX);
+            int x1 = min(x0 + 1, ancho - 1);
+            float dx = srcX - x0;
+
+            const unsigned char* p00 = fila0 + x0 * canales;
+            const unsigned char* p10 = fila0 + x1 * canales;
+            const unsigned char* p01 = fila1 + x0 * canales;
+            const unsigned char* p11 = fila1 + x1 * canales;
+
+            for (int c = 0; c < canales; c++) {
+                float valor = (1 - dx) * (1 - dy) * p00[c] +
+                              dx * (1 - dy) * p10[c] +
+                              (1 - dx) * dy * p01[c] +
+                              dx * dy * p11[c];
+                destino[x * canales + c] = static_cast<unsigned char>(valor);
             }
-            delete[] pixeles[y];
         }
-        delete[] pixeles;
-    
-        // Asignar la nueva matriz
-        pixeles = nuevaMatriz;
-        ancho = nuevoAncho;
-        alto = nuevoAlto;
     }
 
-    // ✅ Implementación para rotar la imagen (sentido antihorario)
-    void Imagen::rotarImagen(float angulo) {
-        float radianes = angulo * M_PI / 180.0;
-        float cosA = cos(radianes);
-        float sinA = sin(radianes);
-    
-        int nuevoAncho = abs(ancho * cosA) + abs(alto * sinA);
-        int nuevoAlto = abs(ancho * sinA) + abs(alto * cosA);
-    
-        unsigned char*** nuevaMatriz = new unsigned char**[nuevoAlto];
-        for (int y = 0; y < nuevoAlto; y++) {
-            nuevaMatriz[y] = new unsigned char*[nuevoAncho];
-            for (int x = 0; x < nuevoAncho; x++) {
-                nuevaMatriz[y][x] = new unsigned char[canales];
+    // Liberar la imagen original y quedarse con la nueva
+    liberarPixeles(pixeles);
+    pixeles = nuevosPixeles;
+    paso = nuevoPaso;
+    ancho = nuevoAncho;
+    alto = nuevoAlto;
+}
+
+// Punto fijo con 32 bits de fracción para las coordenadas de rotación
+static const int BITS_FIJO = 32;
+
+static int64_t aFijo(double valor) {
+    return static_cast<int64_t>(llround(valor * (static_cast<int64_t>(1) << BITS_FIJO)));
+}
+
+static int64_t dividirAbajo(int64_t a, int64_t b) {  // b > 0
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Rango [desde, hasta) de enteros n con 0 <= base + n * paso < limite (puede quedar vacío)
+static void rangoLineal(int64_t base, int64_t paso, int64_t limite, int64_t &desde, int64_t &hasta) {
+    if (paso == 0) {
+        bool dentro = base >= 0 && base < limite;
+        desde = dentro ? INT64_MIN / 2 : 0;
+        hasta = dentro ? INT64_MAX / 2 : 0;
+    } else if (paso > 0) {
+        desde = dividirAbajo(-base + paso - 1, paso);        // techo(-base / paso)
+        hasta = dividirAbajo(limite - base + paso - 1, paso);  // techo((limite - base) / paso)
+    } else {
+        desde = dividirAbajo(base - limite, -paso) + 1;
+        hasta = dividirAbajo(base, -paso) + 1;
+    }
+}
+
+// Intersección, dentro de [inicio, fin), de los tramos donde x e y de origen están en rango
+static void tramoValido(int64_t baseX, int64_t pasoX, int64_t limiteX,
+                        int64_t baseY, int64_t pasoY, int64_t limiteY,
+                        int inicio, int fin, int &desde, int &hasta) {
+    int64_t desdeX, hastaX, desdeY, hastaY;
+    rangoLineal(baseX, pasoX, limiteX, desdeX, hastaX);
+    rangoLineal(baseY, pasoY, limiteY, desdeY, hastaY);
+
+    int64_t d = max<int64_t>(inicio, max(desdeX, desdeY));
+    int64_t h = min<int64_t>(fin, min(hastaX, hastaY));
+    desde = static_cast<int>(min<int64_t>(d, fin));
+    hasta = static_cast<int>(max<int64_t>(h, desde));
+}
+
+// ✅ Implementación para rotar la imagen (sentido antihorario)
+void Imagen::rotarImagen(float angulo, PoolHilos *pool) {
+    float radianes = angulo * M_PI / 180.0;
+    float cosA = cos(radianes);
+    float sinA = sin(radianes);
+
+    int nuevoAncho = abs(ancho * cosA) + abs(alto * sinA);
+    int nuevoAlto = abs(ancho * sinA) + abs(alto * cosA);
+
+    size_t nuevoPaso;
+    unsigned char* nuevosPixeles = reservarPixeles(nuevoAlto, nuevoAncho, nuevoPaso);
+
+    int cx = ancho / 2;
+    int cy = alto / 2;
+    int ncx = nuevoAncho / 2;
+    int ncy = nuevoAlto / 2;
+
+    // Coordenadas de origen en punto fijo: xOriginal(nx, ny) = baseX + nx * pasoXx + ny * pasoXy.
+    // Al ser enteros, avanzar pixel a pixel da exactamente lo mismo que calcular desde cualquier tile.
+    const int64_t pasoXx = aFijo(cosA), pasoXy = aFijo(sinA);
+    const int64_t pasoYx = aFijo(-sinA), pasoYy = aFijo(cosA);
+    // Se suma medio paso de la rejilla de pesos (1/512 px) para que truncar equivalga a redondear:
+    // coordenadas que caen justo en un pixel no se desvían al vecino por el error de cos/sin
+    const int64_t medioPeso = static_cast<int64_t>(1) << (BITS_FIJO - 9);
+    const int64_t baseX = aFijo(cx - cosA * ncx - sinA * ncy) + medioPeso;
+    const int64_t baseY = aFijo(cy + sinA * ncx - cosA * ncy) + medioPeso;
+
+    // x0 >= 0 y x0 + 1 < ancho  <=>  0 <= xFijo < (ancho - 1) en punto fijo (igual para y)
+    const int64_t limiteX = static_cast<int64_t>(ancho - 1) << BITS_FIJO;
+    const int64_t limiteY = static_cast<int64_t>(alto - 1) << BITS_FIJO;
+
+    // El destino se recorre por tiles para que las filas de origen que toca cada uno quepan en caché;
+    // cada píxel se calcula igual que en el recorrido fila por fila, así el resultado no depende de los hilos
+    int tilesX = (nuevoAncho + TAM_TILE - 1) / TAM_TILE;
+    int tilesY = (nuevoAlto + TAM_TILE - 1) / TAM_TILE;
+
+    auto rotarTile = [&](int tile) {
+        int inicioX = (tile % tilesX) * TAM_TILE;
+        int inicioY = (tile / tilesX) * TAM_TILE;
+        int finX = min(inicioX + TAM_TILE, nuevoAncho);
+        int finY = min(inicioY + TAM_TILE, nuevoAlto);
+
+        for (int ny = inicioY; ny < finY; ny++) {
+            unsigned char* destino = nuevosPixeles + ny * nuevoPaso;
+            int64_t filaX = baseX + ny * pasoXy;
+            int64_t filaY = baseY + ny * pasoYy;
+
+            // Tramo [desde, hasta) de la fila cuyo origen cae dentro de la imagen, calculado sin recorrerla
+            int desde, hasta;
+            tramoValido(filaX, pasoXx, limiteX, filaY, pasoYx, limiteY, inicioX, finX, desde, hasta);
+
+            // Fuera del tramo se rellena con blanco
+            memset(destino + inicioX * canales, 255, (desde - inicioX) * canales);
+            memset(destino + hasta * canales, 255, (finX - hasta) * canales);
+
+            int64_t xFijo = filaX + desde * pasoXx;
+            int64_t yFijo = filaY + desde * pasoYx;
+            for (int nx = desde; nx < hasta; nx++) {
+                int x0 = static_cast<int>(xFijo >> BITS_FIJO);
+                int y0 = static_cast<int>(yFijo >> BITS_FIJO);
+                unsigned dx = static_cast<unsigned>(xFijo >> (BITS_FIJO - 8)) & 0xFF;
+                unsigned dy = static_cast<unsigned>(yFijo >> (BITS_FIJO - 8)) & 0xFF;
+
+                const unsigned char* p0 = fila(y0) + x0 * canales;
+                const unsigned char* p1 = fila(y0 + 1) + x0 * canales;
+                unsigned char* salida = destino + nx * canales;
+
                 for (int c = 0; c < canales; c++) {
-                    nuevaMatriz[y][x][c] = 255; // Rellenar con blanco
-                }
-            }
-        }
-    
-        int cx = ancho / 2;
-        int cy = alto / 2;
-        int ncx = nuevoAncho / 2;
-        int ncy = nuevoAlto / 2;
-    
-        for (int ny = 0; ny < nuevoAlto; ny++) {
-            for (int nx = 0; nx < nuevoAncho; nx++) {
-                float xOriginal = cosA * (nx - ncx) + sinA * (ny - ncy) + cx;
-                float yOriginal = -sinA * (nx - ncx) + cosA * (ny - ncy) + cy;
-    
-                int x0 = floor(xOriginal);
-                int y0 = floor(yOriginal);
-                int x1 = x0 + 1;
-                int y1 = y0 + 1;
-    
-                if (x0 >= 0 && x1 < ancho && y0 >= 0 && y1 < alto) {
-                    for (int c = 0; c < canales; c++) {
-                        float p00 = pixeles[y0][x0][c];
-                        float p10 = pixeles[y0][x1][c];
-                        float p01 = pixeles[y1][x0][c];
-                        float p11 = pixeles[y1][x1][c];
-    
-                        float dx = xOriginal - x0;
-                        float dy = yOriginal - y0;
-    
-                        float interpolado = (1 - dx) * (1 - dy) * p00 +
-                                            dx * (1 - dy) * p10 +
-                                            (1 - dx) * dy * p01 +
-                                            dx * dy * p11;
-    
-                        nuevaMatriz[ny][nx][c] = static_cast<unsigned char>(interpolado);
-                    }
+                    unsigned arriba = p0[c] * (256 - dx) + p0[c + canales] * dx;
+                    unsigned abajo = p1[c] * (256 - dx) + p1[c + canales] * dx;
+                    salida[c] = static_cast<unsigned char>((arriba * (256 - dy) + abajo * dy) >> 16);
                 }
+
+                xFijo += pasoXx;
+                yFijo += pasoYx;
             }
         }
-    
-        // Liberar memoria de la imagen original
-        for (int y = 0; y < alto; y++) {
-            for (int x = 0; x < ancho; x++) {
-                delete[] pixeles[y][x];
-            }
-            delete[] pixeles[y];
-        }
-        delete[] pixeles;
-    
-        // Asignar la nueva matriz
-        pixeles = nuevaMatriz;
-        ancho = nuevoAncho;
-        alto = nuevoAlto;
-    }
\ No newline at end of file
+    };
+
+    if (pool) {
+        pool->paraCada(tilesX * tilesY, rotarTile);
+    } else {
+        for (int tile = 0; tile < tilesX * tilesY; tile++) rotarTile(tile);
+    }
+
+    // Liberar la imagen original y quedarse con la rotada
+    liberarPixeles(pixeles);
+    pixeles = nuevosPixeles;
+    paso = nuevoPaso;
+    ancho = nuevoAncho;
+    alto = nuevoAlto;
+}
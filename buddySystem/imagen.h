@@ -2,7 +2,9 @@
 #define IMAGEN_H
 
 #include <string>
+#include <cstddef>
 #include "buddy_allocator.h"
+#include "pool_hilos.h"
 
 class Imagen {
 public:
@@ -10,22 +12,40 @@ public:
     ~Imagen();
 
     void invertirColores();
-    
+
     void guardarImagen(const std::string &nombreArchivo) const;
     void mostrarInfo() const;  // ✅ Declaración como const
 
     // Nuevos métodos para rotación y escalado
-    void rotarImagen(float angulo);
+    // Con pool, los tiles del destino se reparten entre sus hilos (mismo resultado que sin pool)
+    void rotarImagen(float angulo, PoolHilos *pool = nullptr);
     void escalarImagen(float factor);
 
+    // Acceso por filas: cada fila tiene ancho * canales bytes intercalados (RGBRGB...)
+    unsigned char* fila(int y) { return pixeles + y * paso; }
+    const unsigned char* fila(int y) const { return pixeles + y * paso; }
+
+    int obtenerAncho() const { return ancho; }
+    int obtenerAlto() const { return alto; }
+    int obtenerCanales() const { return canales; }
+    size_t obtenerPaso() const { return paso; }
+
+    static const size_t ALINEACION = 64;  // Alineación de los buffers y filas que reserva Imagen
+    static const int TAM_TILE = 64;       // Lado en píxeles de los tiles de rotación
+
 private:
     int alto;
     int ancho;
     int canales;
-    unsigned char ***pixeles;
+    size_t paso;              // Bytes entre el inicio de dos filas
+    unsigned char *pixeles;   // Buffer contiguo de alto * paso bytes, en la arena o en el heap
     BuddyAllocator *allocador;
 
-    void convertirBufferAMatriz(unsigned char* buffer); // ✅ Declaración privada
+    Imagen(const Imagen&);             // No copiable: el buffer tiene un único dueño
+    Imagen& operator=(const Imagen&);
+
+    unsigned char* reservarPixeles(int alto, int ancho, size_t &paso);
+    void liberarPixeles(unsigned char *buffer);
 };
 
 #endif
@@ -1,21 +1,25 @@
 #include "imagen.h"
 #include "buddy_allocator.h"
+#include "pool_hilos.h"
 #include <iostream>
 #include <chrono>
 #include <cstring>
+#include <cstdlib>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
 
 // Muestra cómo se usa el programa desde la línea de comandos
 void mostrarUso() {
-    cout << "Uso: ./main <archivo_entrada> <archivo_salida> <-buddy|-no-buddy>" << endl;
+    cout << "Uso: ./main <archivo_entrada> <archivo_salida> <angulo> <escala> <-buddy|-no-buddy> [--threads N]" << endl;
     cout << "  <archivo_entrada>   Archivo de imagen de entrada (PNG, BMP, JPG)" << endl;
     cout << "  <archivo_salida>    Archivo de salida para la imagen procesada" << endl;
     cout << "  <angulo>            Angulo de rotacion" <<endl;
     cout << "  <escala>            Factor de escala "  <<endl;
     cout << "  -buddy              Usa Buddy System para la asignación de memoria" << endl;
     cout << "  -no-buddy           Usa new/delete para la asignación de memoria" << endl;
+    cout << "  --threads N         Rota por tiles en N hilos (0 = todos los núcleos)" << endl;
 }
 
 // Muestra una lista de chequeo para verificar que los parámetros son correctos
@@ -29,20 +33,40 @@ void mostrarListaChequeo(const string &archivoEntrada, const string &archivoSali
     cout << "------------------------" << endl;
 }
 
+// Rota la imagen midiendo sólo el tiempo de la rotación
+void rotarMidiendo(Imagen &img, float angulo, PoolHilos *pool) {
+    auto inicio = high_resolution_clock::now();
+    img.rotarImagen(angulo, pool);
+    auto fin = high_resolution_clock::now();
+    cout << "Tiempo de rotación (" << (pool ? pool->numeroHilos() : 1) << " hilo(s)): "
+         << duration_cast<microseconds>(fin - inicio).count() / 1000.0 << " ms" << endl;
+}
+
 int main(int argc, char* argv[]) {
+    // Separar la opción --threads de los argumentos posicionales
+    vector<char*> args;
+    int hilos = -1;  // -1 = rotación secuencial
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            hilos = atoi(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
     // Verificar número de argumentos
-    if (argc != 6) {
+    if (args.size() != 6 || hilos < -1) {
         cerr << "Error: Número incorrecto de argumentos." << endl;
         mostrarUso();
         return 1;
     }
 
     // Parámetros de línea de comandos
-    string archivoEntrada = argv[1];
-    string archivoSalida = argv[2];
-    float angulo = atof(argv[3]);
-    float escala = atof(argv[4]);
-    string modoAsignacion = argv[5];
+    string archivoEntrada = args[1];
+    string archivoSalida = args[2];
+    float angulo = atof(args[3]);
+    float escala = atof(args[4]);
+    string modoAsignacion = args[5];
     
     // Verifica si el modo de asignación es válido
     bool usarBuddy = false;
@@ -57,7 +81,10 @@ int main(int argc, char* argv[]) {
     }
 
     // Mostrar lista de chequeo
-    mostrarListaChequeo(archivoEntrada, archivoSalida, usarBuddy, argv[3], argv[4]);
+    mostrarListaChequeo(archivoEntrada, archivoSalida, usarBuddy, args[3], args[4]);
+
+    // Pool de hilos para la rotación (se crea antes de medir para no contar el arranque de hilos)
+    PoolHilos *pool = hilos >= 0 ? new PoolHilos(static_cast<unsigned>(hilos)) : nullptr;
 
     // Medir el tiempo de ejecución
     auto inicio = high_resolution_clock::now();
@@ -74,8 +101,8 @@ int main(int argc, char* argv[]) {
         // Mostrar información de la imagen
         img.mostrarInfo();
 
-        // Invertir colores
-        img.rotarImagen(angulo);
+        // Rotar la imagen
+        rotarMidiendo(img, angulo, pool);
         
         
 
@@ -95,7 +122,7 @@ int main(int argc, char* argv[]) {
         img.mostrarInfo();
 
         
-        img.rotarImagen(angulo);
+        rotarMidiendo(img, angulo, pool);
 
         // Guardar imagen procesada
         img.guardarImagen(archivoSalida);
@@ -107,6 +134,8 @@ int main(int argc, char* argv[]) {
 
     cout << "\nTiempo total de procesamiento: " << duracion << " ms" << endl;
 
+    delete pool;
+
     cout << "\n[INFO] Proceso completado con éxito." << endl;
 
     return 0;
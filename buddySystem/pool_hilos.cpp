@@ -0,0 +1,79 @@
+#include "pool_hilos.h"
+
+PoolHilos::PoolHilos(unsigned hilos)
+    : tareaActual(nullptr), totalTareas(0), siguienteTarea(0),
+      trabajadoresPendientes(0), generacion(0), terminar(false) {
+    if (hilos == 0) hilos = std::thread::hardware_concurrency();
+    if (hilos == 0) hilos = 1;
+
+    // El hilo que llama a paraCada() cuenta como uno más
+    for (unsigned i = 1; i < hilos; i++) {
+        trabajadores.push_back(std::thread(&PoolHilos::bucleTrabajador, this));
+    }
+}
+
+PoolHilos::~PoolHilos() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        terminar = true;
+    }
+    hayTrabajo.notify_all();
+    for (size_t i = 0; i < trabajadores.size(); i++) {
+        trabajadores[i].join();
+    }
+}
+
+// Cada hilo toma el siguiente índice libre hasta agotarlos
+void PoolHilos::consumirTareas() {
+    for (;;) {
+        int i = siguienteTarea.fetch_add(1);
+        if (i >= totalTareas) break;
+        (*tareaActual)(i);
+    }
+}
+
+void PoolHilos::bucleTrabajador() {
+    unsigned vista = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!terminar && generacion == vista) hayTrabajo.wait(lock);
+            if (terminar) return;
+            vista = generacion;
+        }
+
+        consumirTareas();
+
+        bool ultimo;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ultimo = --trabajadoresPendientes == 0;
+        }
+        if (ultimo) trabajoTerminado.notify_all();
+    }
+}
+
+void PoolHilos::paraCada(int n, const std::function<void(int)> &tarea) {
+    if (n <= 0) return;
+    if (trabajadores.empty() || n == 1) {
+        for (int i = 0; i < n; i++) tarea(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tareaActual = &tarea;
+        totalTareas = n;
+        siguienteTarea.store(0);
+        trabajadoresPendientes = trabajadores.size();
+        generacion++;
+    }
+    hayTrabajo.notify_all();
+
+    consumirTareas();
+
+    // Esperar a que todos los trabajadores pasen por esta generación antes de reutilizar el estado
+    std::unique_lock<std::mutex> lock(mutex);
+    while (trabajadoresPendientes > 0) trabajoTerminado.wait(lock);
+    tareaActual = nullptr;
+}
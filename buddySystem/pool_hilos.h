@@ -0,0 +1,45 @@
+#ifndef POOL_HILOS_H
+#define POOL_HILOS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos fijo para repartir trabajo por índices (tiles, filas, bloques).
+// Los hilos se crean una vez y se reutilizan en cada llamada a paraCada().
+class PoolHilos {
+public:
+    // 0 hilos = tantos como núcleos tenga la máquina
+    explicit PoolHilos(unsigned hilos = 0);
+    ~PoolHilos();
+
+    unsigned numeroHilos() const { return static_cast<unsigned>(trabajadores.size()) + 1; }
+
+    // Ejecuta tarea(i) para i en [0, n) repartido entre los hilos; el hilo que llama también trabaja.
+    // Vuelve cuando todas las tareas terminaron.
+    void paraCada(int n, const std::function<void(int)> &tarea);
+
+private:
+    std::vector<std::thread> trabajadores;
+    std::mutex mutex;
+    std::condition_variable hayTrabajo;
+    std::condition_variable trabajoTerminado;
+
+    const std::function<void(int)> *tareaActual;
+    int totalTareas;
+    std::atomic<int> siguienteTarea;
+    size_t trabajadoresPendientes;  // Trabajadores que aún no terminan la generación actual
+    unsigned generacion;
+    bool terminar;
+
+    PoolHilos(const PoolHilos&);
+    PoolHilos& operator=(const PoolHilos&);
+
+    void bucleTrabajador();
+    void consumirTareas();
+};
+
+#endif
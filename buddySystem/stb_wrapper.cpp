@@ -1,4 +1,53 @@
+#include "stb_wrapper.h"
+#include <cstdlib>
+#include <cstring>
+
+#define STBI_MALLOC(sz)                      stbReservar(sz)
+#define STBI_REALLOC_SIZED(p, oldsz, newsz)  stbRedimensionar(p, oldsz, newsz)
+#define STBI_FREE(p)                         stbLiberar(p)
+
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image.h"
 #include "stb_image_write.h"
+
+static BuddyAllocator *allocadorStb = nullptr;
+static const size_t ALINEACION_STB = 64;
+
+void stbUsarAllocador(BuddyAllocator *allocador) {
+    allocadorStb = allocador;
+}
+
+// Intenta primero la arena; si no hay espacio, usa el heap alineado.
+void* stbReservar(size_t tam) {
+    if (allocadorStb && tam <= allocadorStb->memoriaTotal()) {
+        void *ptr = allocadorStb->alloc(tam);
+        if (ptr) return ptr;
+    }
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, ALINEACION_STB, tam ? tam : 1) != 0) return nullptr;
+    return ptr;
+}
+
+void* stbRedimensionar(void *ptr, size_t tamAnterior, size_t tamNuevo) {
+    void *nuevo = stbReservar(tamNuevo);
+    if (!nuevo) return nullptr;
+    if (ptr) {
+        memcpy(nuevo, ptr, tamAnterior < tamNuevo ? tamAnterior : tamNuevo);
+        stbLiberar(ptr);
+    }
+    return nuevo;
+}
+
+void stbLiberar(void *ptr) {
+    liberarBufferStb(ptr, allocadorStb);
+}
+
+void liberarBufferStb(void *ptr, BuddyAllocator *allocador) {
+    if (!ptr) return;
+    if (allocador && allocador->contiene(ptr)) {
+        allocador->free(ptr);
+    } else {
+        std::free(ptr);
+    }
+}
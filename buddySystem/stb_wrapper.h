@@ -0,0 +1,20 @@
+#ifndef STB_WRAPPER_H
+#define STB_WRAPPER_H
+
+#include <cstddef>
+#include "buddy_allocator.h"
+
+// Arena donde stb_image reserva sus buffers (nullptr = heap).
+// stb no recibe contexto en sus hooks, así que la arena es global al proceso.
+void stbUsarAllocador(BuddyAllocator *allocador);
+
+// Hooks STBI_MALLOC / STBI_REALLOC_SIZED / STBI_FREE.
+// Los bloques del heap se reservan alineados a 64 bytes, igual que los de la arena.
+void* stbReservar(size_t tam);
+void* stbRedimensionar(void *ptr, size_t tamAnterior, size_t tamNuevo);
+void stbLiberar(void *ptr);
+
+// Libera un buffer reservado por los hooks, esté en la arena indicada o en el heap.
+void liberarBufferStb(void *ptr, BuddyAllocator *allocador);
+
+#endif
@@ -0,0 +1,567 @@
+// Benchmark de los compresores: genera corpus reproducibles, comprime y descomprime cada uno con
+// cada herramienta (en modo tubería, "-c -" y "-x -") y escribe los resultados en JSON por la
+// salida estándar. El avance se muestra por la salida de errores.
+// Compilar: make (o g++ -std=c++11 -O2 bench_compresion.cpp -o bench_compresion)
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// xorshift64*: la misma semilla da los mismos bytes con cualquier compilador o biblioteca
+class Aleatorio {
+public:
+    explicit Aleatorio(uint64_t semilla) : estado(semilla ? semilla : 1) {}
+
+    uint64_t siguiente() {
+        estado ^= estado >> 12;
+        estado ^= estado << 25;
+        estado ^= estado >> 27;
+        return estado * 2685821657736338717ULL;
+    }
+
+    uint32_t hasta(uint32_t n) { return static_cast<uint32_t>((siguiente() >> 32) % n); }
+
+private:
+    uint64_t estado;
+};
+
+
+// Cada corpus se arma concatenando piezas (una línea, un registro, un bloque de bytes) hasta el
+// tamaño pedido. Con la misma semilla, el corpus chico es prefijo del grande.
+class Corpus {
+public:
+    explicit Corpus(uint64_t semilla) : rng(semilla) {}
+    virtual ~Corpus() {}
+    virtual void pieza(string& salida) = 0;
+
+protected:
+    Aleatorio rng;
+};
+
+// Bytes uniformes: no se pueden comprimir
+class CorpusAleatorio : public Corpus {
+public:
+    explicit CorpusAleatorio(uint64_t semilla) : Corpus(semilla) {}
+
+    void pieza(string& salida) {
+        for (int i = 0; i < 512; i++) {
+            uint64_t palabra = rng.siguiente();
+            salida.append(reinterpret_cast<const char*>(&palabra), sizeof(palabra));
+        }
+    }
+};
+
+const char* const PALABRAS[] = {
+    "de", "la", "que", "el", "en", "y", "a", "los", "se", "del", "las", "un", "por", "con", "no",
+    "una", "su", "para", "es", "al", "lo", "como", "más", "pero", "sus", "le", "ya", "o", "este",
+    "sistema", "archivo", "proceso", "memoria", "bloque", "datos", "tiempo", "usuario", "hilo",
+    "operativo", "disco", "página", "tabla", "código", "programa", "núcleo", "buffer", "señal",
+    "cuando", "también", "entre", "sobre", "todo", "desde", "hasta", "donde", "cada", "otro",
+    "compresión", "algoritmo", "diccionario", "frecuencia", "árbol", "caracter", "imagen",
+    "resultado", "tamaño", "espacio", "lectura", "escritura", "descriptor", "llamada", "error",
+    "puede", "tiene", "hace", "forma", "parte", "manera", "ejemplo", "caso", "vez", "primero",
+    "segundo", "último", "grande", "pequeño", "nuevo", "mismo", "propio", "general", "posible",
+};
+const uint32_t CANTIDAD_PALABRAS = sizeof(PALABRAS) / sizeof(PALABRAS[0]);
+
+// Oraciones con palabras frecuentes y raras, al estilo de un texto en español
+class CorpusTexto : public Corpus {
+public:
+    explicit CorpusTexto(uint64_t semilla) : Corpus(semilla) {}
+
+    void pieza(string& salida) {
+        int palabras = 4 + rng.hasta(16);
+        for (int i = 0; i < palabras; i++) {
+            // El producto de dos índices favorece las primeras palabras (distribución aproximada de Zipf)
+            uint32_t indice = rng.hasta(CANTIDAD_PALABRAS) * rng.hasta(CANTIDAD_PALABRAS) / CANTIDAD_PALABRAS;
+            string palabra = PALABRAS[indice];
+            if (i == 0) palabra[0] = static_cast<char>(toupper(palabra[0]));
+            salida += palabra;
+            salida += i + 1 < palabras ? (rng.hasta(12) == 0 ? ", " : " ") : ".";
+        }
+        salida += rng.hasta(5) == 0 ? "\n\n" : " ";
+    }
+};
+
+// Una misma línea repetida con alguna mutación ocasional
+class CorpusRepetitivo : public Corpus {
+public:
+    explicit CorpusRepetitivo(uint64_t semilla) : Corpus(semilla) {
+        for (int i = 0; i < 200; i++) patron += static_cast<char>('a' + rng.hasta(26));
+        patron += '\n';
+    }
+
+    void pieza(string& salida) {
+        size_t inicio = salida.size();
+        salida += patron;
+        if (rng.hasta(32) == 0) salida[inicio + rng.hasta(200)] = static_cast<char>('A' + rng.hasta(26));
+    }
+
+private:
+    string patron;
+};
+
+// Registros binarios de 32 bytes como los de una tabla volcada a disco: enteros que crecen de a
+// poco, un valor que hace una caminata aleatoria, pocos tipos y nombres, y relleno en cero
+class CorpusBinario : public Corpus {
+public:
+    explicit CorpusBinario(uint64_t semilla) : Corpus(semilla), id(0), marca(1700000000), valor(0) {}
+
+    void pieza(string& salida) {
+        static const char* const NOMBRES[] = {"sensor-a", "sensor-b", "bomba", "valvula", "motor"};
+        char registro[32] = {0};
+        id++;
+        marca += rng.hasta(1000);
+        valor += static_cast<int32_t>(rng.hasta(21)) - 10;
+        uint16_t tipo = static_cast<uint16_t>(rng.hasta(8));
+        uint16_t banderas = rng.hasta(16) == 0 ? static_cast<uint16_t>(rng.siguiente()) : 0;
+        memcpy(registro, &id, 4);
+        memcpy(registro + 4, &marca, 4);
+        memcpy(registro + 8, &valor, 4);
+        memcpy(registro + 12, &tipo, 2);
+        memcpy(registro + 14, &banderas, 2);
+        strncpy(registro + 16, NOMBRES[rng.hasta(5)], 15);
+        salida.append(registro, sizeof(registro));
+    }
+
+private:
+    uint32_t id;
+    uint32_t marca;
+    int32_t valor;
+};
+
+// Líneas de log: marca de tiempo creciente, nivel, módulo, mensaje con números e IPs
+class CorpusRegistros : public Corpus {
+public:
+    explicit CorpusRegistros(uint64_t semilla) : Corpus(semilla), milisegundos(0) {}
+
+    void pieza(string& salida) {
+        static const char* const NIVELES[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+        static const char* const MODULOS[] = {"http", "db", "cache", "auth", "cola", "planificador"};
+        static const char* const MENSAJES[] = {
+            "solicitud atendida", "conexión abierta", "conexión cerrada", "consulta lenta",
+            "reintento programado", "sesión expirada", "bloque escrito", "tiempo de espera agotado",
+        };
+        milisegundos += rng.hasta(50);
+        uint64_t s = milisegundos / 1000;
+        char linea[256];
+        int n = snprintf(linea, sizeof(linea),
+                         "2026-10-%02u %02u:%02u:%02u.%03u %-5s [%s] %s id=%u ip=10.%u.%u.%u ms=%u\n",
+                         unsigned(1 + s / 86400 % 28), unsigned(s / 3600 % 24), unsigned(s / 60 % 60),
+                         unsigned(s % 60), unsigned(milisegundos % 1000), NIVELES[rng.hasta(6)],
+                         MODULOS[rng.hasta(6)], MENSAJES[rng.hasta(8)], rng.hasta(100000),
+                         rng.hasta(4), rng.hasta(256), rng.hasta(256), rng.hasta(2000));
+        salida.append(linea, n);
+    }
+
+private:
+    uint64_t milisegundos;
+};
+
+const char* const TIPOS_CORPUS[] = {"aleatorio", "texto", "repetitivo", "binario", "registros"};
+
+unique_ptr<Corpus> crearCorpus(const string& tipo) {
+    // Semilla fija por tipo para que los corpus sean iguales en cada corrida
+    uint64_t semilla = 2026;
+    for (char c : tipo) semilla = semilla * 131 + static_cast<unsigned char>(c);
+    if (tipo == "aleatorio") return unique_ptr<Corpus>(new CorpusAleatorio(semilla));
+    if (tipo == "texto") return unique_ptr<Corpus>(new CorpusTexto(semilla));
+    if (tipo == "repetitivo") return unique_ptr<Corpus>(new CorpusRepetitivo(semilla));
+    if (tipo == "binario") return unique_ptr<Corpus>(new CorpusBinario(semilla));
+    if (tipo == "registros") return unique_ptr<Corpus>(new CorpusRegistros(semilla));
+    return unique_ptr<Corpus>();
+}
+
+uint64_t tamanoArchivo(const string& ruta) {
+    struct stat info;
+    return stat(ruta.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+// Escribe el corpus en 'ruta'; si ya existe con el tamaño pedido se reutiliza
+bool generarCorpus(const string& tipo, uint64_t tamano, const string& ruta) {
+    if (tamanoArchivo(ruta) == tamano) return true;
+    unique_ptr<Corpus> corpus = crearCorpus(tipo);
+    ofstream salida(ruta, ios::binary);
+    string pieza;
+    uint64_t escritos = 0;
+    while (escritos < tamano && salida) {
+        pieza.clear();
+        corpus->pieza(pieza);
+        size_t n = static_cast<size_t>(min<uint64_t>(pieza.size(), tamano - escritos));
+        salida.write(pieza.data(), n);
+        escritos += n;
+    }
+    salida.close();
+    return static_cast<bool>(salida);
+}
+
+bool mismosBytes(const string& a, const string& b) {
+    ifstream x(a, ios::binary), y(b, ios::binary);
+    vector<char> bx(1 << 20), by(1 << 20);
+    while (x && y) {
+        x.read(bx.data(), bx.size());
+        y.read(by.data(), by.size());
+        if (x.gcount() != y.gcount() || memcmp(bx.data(), by.data(), x.gcount()) != 0) return false;
+    }
+    return x.eof() && y.eof();
+}
+
+
+// Resultado de una ejecución de la herramienta; -1 = desconocido
+struct Medicion {
+    double segundos;
+    long rssMaximoKB;
+    long long asignaciones;
+    long long bytesAsignados;
+    bool correcta;
+};
+
+// Ejecuta 'argumentos' con la entrada y salida estándar redirigidas a archivos. El RSS máximo sale
+// de wait4() y las asignaciones del contador cargado con LD_PRELOAD, si se indicó.
+Medicion ejecutar(const vector<string>& argumentos, const string& entrada, const string& salida,
+                  const string& contador) {
+    Medicion medicion = {0, -1, -1, -1, false};
+    string archivoCuenta = salida + ".asignaciones";
+    unlink(archivoCuenta.c_str());
+
+    int fdEntrada = open(entrada.c_str(), O_RDONLY);
+    int fdSalida = open(salida.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fdEntrada < 0 || fdSalida < 0) {
+        if (fdEntrada >= 0) close(fdEntrada);
+        if (fdSalida >= 0) close(fdSalida);
+        return medicion;
+    }
+
+    auto inicio = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fdEntrada, STDIN_FILENO);
+        dup2(fdSalida, STDOUT_FILENO);
+        if (!contador.empty()) {
+            setenv("LD_PRELOAD", contador.c_str(), 1);
+            setenv("BENCH_ASIGNACIONES", archivoCuenta.c_str(), 1);
+        }
+        vector<char*> argv;
+        for (const string& a : argumentos) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        perror("execv");
+        _exit(127);
+    }
+    close(fdEntrada);
+    close(fdSalida);
+    if (pid < 0) return medicion;
+
+    int estado;
+    struct rusage uso;
+    if (wait4(pid, &estado, 0, &uso) != pid) return medicion;
+    medicion.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    medicion.rssMaximoKB = uso.ru_maxrss;
+    medicion.correcta = WIFEXITED(estado) && WEXITSTATUS(estado) == 0;
+
+    ifstream cuenta(archivoCuenta);
+    if (!(cuenta >> medicion.asignaciones >> medicion.bytesAsignados)) {
+        medicion.asignaciones = medicion.bytesAsignados = -1;
+    }
+    unlink(archivoCuenta.c_str());
+    return medicion;
+}
+
+// Conserva el tiempo de la corrida más rápida y el mayor RSS de todas
+void acumular(Medicion& mejor, const Medicion& nueva, bool primera) {
+    long rss = primera ? nueva.rssMaximoKB : max(mejor.rssMaximoKB, nueva.rssMaximoKB);
+    bool correcta = (primera || mejor.correcta) && nueva.correcta;
+    if (primera || nueva.segundos < mejor.segundos) mejor = nueva;
+    mejor.rssMaximoKB = rss;
+    mejor.correcta = correcta;
+}
+
+// Herramienta a medir: binario y opciones de compresión
+struct Codec {
+    string nombre;
+    string binario;
+    vector<string> opciones;
+};
+
+
+// Opciones de la línea de comandos
+struct Configuracion {
+    vector<uint64_t> tamanos;
+    vector<string> corpus;
+    vector<string> codecs;
+    int repeticiones;
+    string lzw;
+    string huffman;
+    string contador;
+    string directorio;
+    long hilos;
+};
+
+vector<string> separar(const string& lista) {
+    vector<string> partes;
+    stringstream flujo(lista);
+    string parte;
+    while (getline(flujo, parte, ',')) {
+        if (!parte.empty()) partes.push_back(parte);
+    }
+    return partes;
+}
+
+// "64K", "16M", "1G" o bytes
+bool leerTamano(const string& texto, uint64_t& tamano) {
+    char* fin;
+    unsigned long long valor = strtoull(texto.c_str(), &fin, 10);
+    string sufijo = fin;
+    if (fin == texto.c_str() || valor == 0) return false;
+    if (sufijo == "K") valor <<= 10;
+    else if (sufijo == "M") valor <<= 20;
+    else if (sufijo == "G") valor <<= 30;
+    else if (!sufijo.empty()) return false;
+    tamano = valor;
+    return true;
+}
+
+string nombreTamano(uint64_t tamano) {
+    if (tamano % (1 << 30) == 0) return to_string(tamano >> 30) + "G";
+    if (tamano % (1 << 20) == 0) return to_string(tamano >> 20) + "M";
+    if (tamano % (1 << 10) == 0) return to_string(tamano >> 10) + "K";
+    return to_string(tamano);
+}
+
+void mostrarAyuda() {
+    cerr << "Uso: bench_compresion [opciones] > resultados.json\n\n"
+         << "  --tamanos <lista>      Tamaños de los corpus (por defecto 1K,64K,1M,16M; admite K, M y G)\n"
+         << "  --corpus <lista>       aleatorio,texto,repetitivo,binario,registros (por defecto todos)\n"
+         << "  --codecs <lista>       lzw,lzw-16,huffman (por defecto todos)\n"
+         << "  --repeticiones <n>     Se informa la corrida más rápida (por defecto 3)\n"
+         << "  --lzw <ruta>           Binario de lzw (por defecto ../lzw/lzw)\n"
+         << "  --huffman <ruta>       Binario de huffman (por defecto ../huffman/huffman)\n"
+         << "  --contador <ruta>      Biblioteca que cuenta asignaciones (por defecto ./contador_asignaciones.so)\n"
+         << "  --hilos <n>            Hilos de huffman (por defecto todos los núcleos)\n"
+         << "  --dir <directorio>     Guarda los corpus ahí y los reutiliza en la siguiente corrida\n";
+}
+
+bool leerConfiguracion(int argc, char* argv[], Configuracion& config) {
+    config.tamanos = {1 << 10, 64 << 10, 1 << 20, 16 << 20};
+    config.corpus.assign(begin(TIPOS_CORPUS), end(TIPOS_CORPUS));
+    config.codecs = {"lzw", "lzw-16", "huffman"};
+    config.repeticiones = 3;
+    config.lzw = "../lzw/lzw";
+    config.huffman = "../huffman/huffman";
+    config.contador = "./contador_asignaciones.so";
+    config.hilos = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string opcion = argv[i];
+        if (opcion == "-h" || opcion == "--help") return false;
+        if (i + 1 >= argc) {
+            cerr << "Falta el valor de " << opcion << endl;
+            return false;
+        }
+        string valor = argv[++i];
+        if (opcion == "--tamanos") {
+            config.tamanos.clear();
+            for (const string& t : separar(valor)) {
+                uint64_t tamano;
+                if (!leerTamano(t, tamano)) {
+                    cerr << "Tamaño inválido: " << t << endl;
+                    return false;
+                }
+                config.tamanos.push_back(tamano);
+            }
+        } else if (opcion == "--corpus") {
+            config.corpus = separar(valor);
+        } else if (opcion == "--codecs") {
+            config.codecs = separar(valor);
+        } else if (opcion == "--repeticiones") {
+            config.repeticiones = max(1, atoi(valor.c_str()));
+        } else if (opcion == "--lzw") {
+            config.lzw = valor;
+        } else if (opcion == "--huffman") {
+            config.huffman = valor;
+        } else if (opcion == "--contador") {
+            config.contador = valor;
+        } else if (opcion == "--hilos") {
+            config.hilos = atol(valor.c_str());
+        } else if (opcion == "--dir") {
+            config.directorio = valor;
+        } else {
+            cerr << "Opción desconocida: " << opcion << endl;
+            return false;
+        }
+    }
+    for (const string& tipo : config.corpus) {
+        if (!crearCorpus(tipo)) {
+            cerr << "Corpus desconocido: " << tipo << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Las rutas relativas se vuelven absolutas: los corpus pueden quedar en otro directorio
+string rutaAbsoluta(const string& ruta) {
+    char* absoluta = realpath(ruta.c_str(), nullptr);
+    if (!absoluta) return ruta;
+    string resultado = absoluta;
+    free(absoluta);
+    return resultado;
+}
+
+string textoJSON(const string& texto) {
+    string resultado = "\"";
+    for (char c : texto) {
+        if (c == '"' || c == '\\') resultado += '\\';
+        resultado += c;
+    }
+    return resultado + "\"";
+}
+
+void escribirMedicion(ostream& json, const char* nombre, const Medicion& m, uint64_t tamano) {
+    char numeros[64];
+    snprintf(numeros, sizeof(numeros), "%.6f", m.segundos);
+    json << "      " << textoJSON(nombre) << ": {\"segundos\": " << numeros;
+    snprintf(numeros, sizeof(numeros), "%.2f", m.segundos > 0 ? tamano / 1e6 / m.segundos : 0.0);
+    json << ", \"mb_s\": " << numeros << ", \"rss_max_kb\": " << m.rssMaximoKB
+         << ", \"asignaciones\": " << m.asignaciones << ", \"bytes_asignados\": " << m.bytesAsignados << "}";
+}
+
+
+int main(int argc, char* argv[]) {
+    Configuracion config;
+    if (!leerConfiguracion(argc, argv, config)) {
+        mostrarAyuda();
+        return 1;
+    }
+
+    vector<Codec> disponibles = {
+        {"lzw", rutaAbsoluta(config.lzw), {"-b", "12"}},
+        {"lzw-16", rutaAbsoluta(config.lzw), {"-b", "16"}},
+        {"huffman", rutaAbsoluta(config.huffman), {}},
+    };
+    if (config.hilos > 0) disponibles[2].opciones = {"-t", to_string(config.hilos)};
+
+    vector<Codec> codecs;
+    for (const string& nombre : config.codecs) {
+        bool encontrado = false;
+        for (const Codec& codec : disponibles) {
+            if (codec.nombre == nombre) {
+                codecs.push_back(codec);
+                encontrado = true;
+            }
+        }
+        if (!encontrado) {
+            cerr << "Codec desconocido: " << nombre << endl;
+            return 1;
+        }
+        if (access(codecs.back().binario.c_str(), X_OK) != 0) {
+            cerr << "No se puede ejecutar " << codecs.back().binario << " (¿falta compilarlo?)" << endl;
+            return 1;
+        }
+    }
+
+    string contador;
+    if (access(config.contador.c_str(), R_OK) == 0) {
+        contador = rutaAbsoluta(config.contador);
+    } else {
+        cerr << "Aviso: sin " << config.contador << " no se cuentan las asignaciones" << endl;
+    }
+
+    // Sin --dir los corpus van a un directorio temporal que se borra al terminar
+    bool temporal = config.directorio.empty();
+    if (temporal) {
+        char plantilla[] = "/tmp/bench_compresion.XXXXXX";
+        if (!mkdtemp(plantilla)) {
+            perror("mkdtemp");
+            return 1;
+        }
+        config.directorio = plantilla;
+    } else {
+        mkdir(config.directorio.c_str(), 0755);
+    }
+    string directorio = config.directorio + "/";
+
+    ostream& json = cout;
+    json << "{\n  \"formato\": 1,\n  \"nucleos\": " << thread::hardware_concurrency()
+         << ",\n  \"repeticiones\": " << config.repeticiones << ",\n  \"herramientas\": {";
+    for (size_t i = 0; i < codecs.size(); i++) {
+        json << (i ? ", " : "") << textoJSON(codecs[i].nombre) << ": " << textoJSON(codecs[i].binario);
+    }
+    json << "},\n  \"resultados\": [";
+
+    bool primero = true;
+    bool todoCorrecto = true;
+    for (const string& tipo : config.corpus) {
+        for (uint64_t tamano : config.tamanos) {
+            string original = directorio + tipo + "-" + nombreTamano(tamano) + ".dat";
+            cerr << "Generando " << original << endl;
+            if (!generarCorpus(tipo, tamano, original)) {
+                cerr << "Error: No se pudo escribir " << original << endl;
+                return 1;
+            }
+
+            for (const Codec& codec : codecs) {
+                string comprimido = directorio + "comprimido.tmp";
+                string recuperado = directorio + "recuperado.tmp";
+                vector<string> comprimir = {codec.binario};
+                comprimir.insert(comprimir.end(), codec.opciones.begin(), codec.opciones.end());
+                comprimir.push_back("-c");
+                comprimir.push_back("-");
+                vector<string> descomprimir = {codec.binario};
+                if (codec.nombre == "huffman") {
+                    descomprimir.insert(descomprimir.end(), codec.opciones.begin(), codec.opciones.end());
+                }
+                descomprimir.push_back("-x");
+                descomprimir.push_back("-");
+
+                Medicion mejorC, mejorD;
+                for (int r = 0; r < config.repeticiones; r++) {
+                    acumular(mejorC, ejecutar(comprimir, original, comprimido, contador), r == 0);
+                    acumular(mejorD, ejecutar(descomprimir, comprimido, recuperado, contador), r == 0);
+                }
+                bool correcto = mejorC.correcta && mejorD.correcta && mismosBytes(original, recuperado);
+                todoCorrecto = todoCorrecto && correcto;
+                uint64_t bytesComprimidos = tamanoArchivo(comprimido);
+
+                char ratio[32];
+                snprintf(ratio, sizeof(ratio), "%.4f", double(bytesComprimidos) / tamano);
+                json << (primero ? "\n" : ",\n") << "    {\"codec\": " << textoJSON(codec.nombre)
+                     << ", \"corpus\": " << textoJSON(tipo) << ", \"tamano\": " << tamano
+                     << ", \"bytes_comprimidos\": " << bytesComprimidos << ", \"ratio\": " << ratio
+                     << ", \"correcto\": " << (correcto ? "true" : "false") << ",\n";
+                escribirMedicion(json, "compresion", mejorC, tamano);
+                json << ",\n";
+                escribirMedicion(json, "descompresion", mejorD, tamano);
+                json << "}";
+                primero = false;
+
+                cerr << "  " << codec.nombre << ": ratio " << ratio << ", "
+                     << int(tamano / 1e6 / max(mejorC.segundos, 1e-9)) << " / "
+                     << int(tamano / 1e6 / max(mejorD.segundos, 1e-9)) << " MB/s"
+                     << (correcto ? "" : "  ¡NO COINCIDE!") << endl;
+                unlink(comprimido.c_str());
+                unlink(recuperado.c_str());
+            }
+            if (temporal) unlink(original.c_str());
+        }
+    }
+    json << "\n  ]\n}" << endl;
+
+    if (temporal) rmdir(config.directorio.c_str());
+    return todoCorrecto ? 0 : 2;
+}
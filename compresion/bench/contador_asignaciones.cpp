@@ -0,0 +1,77 @@
+// Biblioteca para LD_PRELOAD que cuenta las asignaciones del programa medido (malloc, calloc,
+// realloc y las alineadas; new termina en malloc). Al salir escribe "asignaciones bytes" en el
+// archivo indicado por la variable BENCH_ASIGNACIONES.
+// Compilar: g++ -std=c++11 -O2 -shared -fPIC contador_asignaciones.cpp -o contador_asignaciones.so
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Implementaciones de glibc: se llaman directamente y no hace falta dlsym
+extern "C" {
+void* __libc_malloc(size_t tamano);
+void* __libc_calloc(size_t cantidad, size_t tamano);
+void* __libc_realloc(void* puntero, size_t tamano);
+void* __libc_memalign(size_t alineacion, size_t tamano);
+}
+
+static std::atomic<unsigned long long> asignaciones(0);
+static std::atomic<unsigned long long> bytesAsignados(0);
+
+static void contar(size_t bytes) {
+    asignaciones.fetch_add(1, std::memory_order_relaxed);
+    bytesAsignados.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void* malloc(size_t tamano) {
+    contar(tamano);
+    return __libc_malloc(tamano);
+}
+
+void* calloc(size_t cantidad, size_t tamano) {
+    contar(cantidad * tamano);
+    return __libc_calloc(cantidad, tamano);
+}
+
+void* realloc(void* puntero, size_t tamano) {
+    if (tamano > 0) contar(tamano);
+    return __libc_realloc(puntero, tamano);
+}
+
+void* memalign(size_t alineacion, size_t tamano) {
+    contar(tamano);
+    return __libc_memalign(alineacion, tamano);
+}
+
+void* aligned_alloc(size_t alineacion, size_t tamano) {
+    contar(tamano);
+    return __libc_memalign(alineacion, tamano);
+}
+
+int posix_memalign(void** puntero, size_t alineacion, size_t tamano) {
+    contar(tamano);
+    void* bloque = __libc_memalign(alineacion, tamano);
+    if (!bloque) return ENOMEM;
+    *puntero = bloque;
+    return 0;
+}
+
+}
+
+// Sin asignar memoria: snprintf a un arreglo local y write()
+__attribute__((destructor)) static void informar() {
+    const char* ruta = getenv("BENCH_ASIGNACIONES");
+    if (!ruta) return;
+    char linea[64];
+    int n = snprintf(linea, sizeof(linea), "%llu %llu\n", asignaciones.load(), bytesAsignados.load());
+    int fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    // Si la escritura falla el benchmark informa las asignaciones como desconocidas
+    ssize_t escritos = write(fd, linea, n);
+    (void)escritos;
+    close(fd);
+}
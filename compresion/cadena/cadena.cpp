@@ -0,0 +1,404 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include "../codec/codec.h"
+#include "../codec/cifrado.h"
+#include "../comun/anillo.h"
+#include "../comun/entrada.h"
+
+// Cada etapa corre en su propio hilo y le pasa su salida a la siguiente por un anillo de este
+// tamaño, así la memoria queda acotada por la cantidad de etapas y no por el archivo
+static const size_t TAM_ANILLO = 1 << 20;
+static const size_t TAM_SALIDA = 1 << 18;
+
+// Mostrar mensaje de ayuda
+void mostrarAyuda() {
+    std::cout << "Uso: cadena [opciones] -c|-x <archivo>" << std::endl;
+    std::cout << "Opciones:" << std::endl;
+    std::cout << "  -h, --help: Mostrar este mensaje de ayuda" << std::endl;
+    std::cout << "  -v, --version: Mostrar la versión del programa" << std::endl;
+    std::cout << "  -c, --compress <archivo>: Pasar el archivo por las etapas, en orden" << std::endl;
+    std::cout << "  -x, --decompress <archivo>: Deshacer las etapas, en el orden inverso" << std::endl;
+    std::cout << "  -e, --etapas <lista>: Etapas separadas por comas (por defecto lzw,xor):" << std::endl;
+    std::cout << "        huffman[:KB]  Huffman por bloques, con el tamaño de bloque en KB" << std::endl;
+    std::cout << "        lzw[:bits]    LZW, con el ancho máximo de los códigos (12 a 16)" << std::endl;
+    std::cout << "        xor           XOR del encriptador" << std::endl;
+    std::cout << "        chacha        ChaCha20 del encriptador, con la clave de -k" << std::endl;
+    std::cout << "  -k <archivo>: Clave para chacha (32 bytes o 64 dígitos hexadecimales); sin -k" << std::endl;
+    std::cout << "        se usa " KEY_ENV " si está definida" << std::endl;
+    std::cout << "  -t, --threads <n>: Hilos de cada etapa huffman (por defecto 1, 0 = todos los núcleos)" << std::endl;
+    std::cout << "  -o <archivo>: Nombre del resultado (por defecto se agregan o se quitan las" << std::endl;
+    std::cout << "        extensiones de las etapas, por ejemplo datos.txt.lzw.xor)" << std::endl;
+    std::cout << "Con '-' como archivo se lee la entrada estándar y se escribe la salida estándar," << std::endl;
+    std::cout << "por ejemplo: tar cf - dir | cadena -e huffman,lzw,xor -c - > dir.tar.huff.lzw.xor" << std::endl;
+}
+
+// Mostrar la versión del programa
+void mostrarVersion() {
+    std::cout << "Cadena 1.0" << std::endl;
+}
+
+enum TipoEtapa { ETAPA_HUFFMAN, ETAPA_LZW, ETAPA_XOR, ETAPA_CHACHA };
+
+// Una etapa tal como se pidió en -e
+struct DefinicionEtapa {
+    TipoEtapa tipo;
+    std::string nombre;
+    long parametro;  // KB de bloque para huffman, bits para lzw
+};
+
+// Lee un entero positivo de la línea de comandos
+bool leerNumero(const char* texto, long& valor) {
+    char* fin;
+    valor = strtol(texto, &fin, 10);
+    return *texto != '\0' && *fin == '\0' && valor >= 0;
+}
+
+// Interpreta la lista de -e; informa la primera etapa que no reconoce
+bool leerEtapas(const std::string& lista, std::vector<DefinicionEtapa>& etapas) {
+    std::stringstream partes(lista);
+    std::string parte;
+    while (std::getline(partes, parte, ',')) {
+        DefinicionEtapa etapa;
+        size_t separador = parte.find(':');
+        etapa.nombre = parte.substr(0, separador);
+        std::string parametro = separador == std::string::npos ? "" : parte.substr(separador + 1);
+        bool valido = true;
+        if (etapa.nombre == "huffman") {
+            etapa.tipo = ETAPA_HUFFMAN;
+            etapa.parametro = HUFFMAN_DEFAULT_BLOCK_SIZE / 1024;
+            if (!parametro.empty()) valido = leerNumero(parametro.c_str(), etapa.parametro);
+            size_t tamBloque = static_cast<size_t>(etapa.parametro) * 1024;
+            valido = valido && tamBloque >= HUFFMAN_MIN_BLOCK_SIZE && tamBloque <= HUFFMAN_MAX_BLOCK_SIZE;
+        } else if (etapa.nombre == "lzw") {
+            etapa.tipo = ETAPA_LZW;
+            etapa.parametro = LZW_DEFAULT_MAX_BITS;
+            if (!parametro.empty()) valido = leerNumero(parametro.c_str(), etapa.parametro);
+            valido = valido && etapa.parametro >= LZW_MIN_MAX_BITS && etapa.parametro <= LZW_MAX_MAX_BITS;
+        } else if (etapa.nombre == "xor" || etapa.nombre == "chacha") {
+            etapa.tipo = etapa.nombre == "xor" ? ETAPA_XOR : ETAPA_CHACHA;
+            etapa.parametro = 0;
+            valido = separador == std::string::npos;
+        } else {
+            valido = false;
+        }
+        if (!valido) {
+            std::cerr << "Error: Etapa no válida: " << parte << std::endl;
+            return false;
+        }
+        etapas.push_back(etapa);
+    }
+    if (etapas.empty()) {
+        std::cerr << "Error: La cadena no tiene etapas" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Extensión que agrega cada etapa al comprimir
+std::string extension(const DefinicionEtapa& etapa) {
+    switch (etapa.tipo) {
+    case ETAPA_HUFFMAN: return ".huff";
+    case ETAPA_LZW: return ".lzw";
+    case ETAPA_XOR: return ".xor";
+    default: return ".chacha";
+    }
+}
+
+// Clave de ChaCha20 del archivo de -k, o de la variable de entorno si no se indicó
+bool cargarClave(const char* archivoClave, uint32_t clave[8]) {
+    std::string texto;
+    if (archivoClave) {
+        std::ifstream archivo(archivoClave, std::ios::binary);
+        if (!archivo) {
+            perror("Error al abrir el archivo de la clave");
+            return false;
+        }
+        char parte[256];
+        while (texto.size() < 4096 && archivo.read(parte, sizeof(parte)).gcount() > 0) texto.append(parte, archivo.gcount());
+    } else if (const char* valor = getenv(KEY_ENV)) {
+        texto = valor;
+    } else {
+        std::cerr << "Error: La etapa chacha necesita una clave (-k o " KEY_ENV ")" << std::endl;
+        return false;
+    }
+    if (!codec::parse_key(texto.data(), texto.size(), clave)) {
+        std::cerr << "Error: La clave debe tener 32 bytes o 64 dígitos hexadecimales" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+typedef std::unique_ptr<codec::Stream, codec::Deleter> FlujoPtr;
+
+// El códec de una etapa, en el sentido que corresponde
+codec::Stream* crearCodec(const DefinicionEtapa& etapa, bool codificar, unsigned hilos, const uint32_t* clave) {
+    switch (etapa.tipo) {
+    case ETAPA_HUFFMAN:
+        if (codificar) return codec::newHuffmanEncoder(static_cast<size_t>(etapa.parametro) * 1024, hilos);
+        return codec::newHuffmanDecoder(hilos);
+    case ETAPA_LZW:
+        if (codificar) return codec::newLzwEncoder(static_cast<int>(etapa.parametro));
+        return codec::newLzwDecoder();
+    case ETAPA_XOR:
+        if (codificar) return codec::newXorEncoder();
+        return codec::newXorDecoder();
+    default:
+        if (codificar) return codec::newChaChaEncoder(clave);
+        return codec::newChaChaDecoder(clave);
+    }
+}
+
+enum ResultadoEtapa { ETAPA_OK, ETAPA_ERROR_LECTURA, ETAPA_ERROR_CODEC, ETAPA_ERROR_ESCRITURA, ETAPA_INTERRUMPIDA };
+
+// Una etapa en marcha. La primera lee el archivo de entrada y la última escribe el resultado;
+// entre dos etapas seguidas hay un anillo.
+struct Etapa {
+    std::string nombre;
+    FlujoPtr flujo;
+    Anillo* entrada;        // nullptr en la primera
+    Anillo* salida;         // nullptr en la última
+    ResultadoEtapa resultado;
+    int errorLectura;       // errno de la lectura fallida, que se informa después desde otro hilo
+};
+
+// Retira la salida pendiente del códec hacia el anillo de la etapa siguiente, o al archivo
+ResultadoEtapa vaciar(Etapa& etapa, std::ostream& archivo, std::vector<unsigned char>& buffer) {
+    if (etapa.salida) {
+        while (etapa.flujo->pending() > 0) {
+            size_t libre;
+            unsigned char* destino = etapa.salida->espacio(libre);
+            if (libre == 0) return ETAPA_INTERRUMPIDA;
+            etapa.salida->publicar(etapa.flujo->pull(destino, libre));
+        }
+        return ETAPA_OK;
+    }
+    size_t n;
+    while ((n = etapa.flujo->pull(buffer.data(), buffer.size())) > 0) {
+        if (!archivo.write(reinterpret_cast<const char*>(buffer.data()), n)) return ETAPA_ERROR_ESCRITURA;
+    }
+    return ETAPA_OK;
+}
+
+// Siguiente tramo de entrada de la etapa: del archivo (un archivo mapeado, entero) o del anillo
+ResultadoEtapa siguienteTramo(Etapa& etapa, LectorEntrada& lector, Tramo& tramo) {
+    if (etapa.entrada) return etapa.entrada->datos(tramo) ? ETAPA_OK : ETAPA_INTERRUMPIDA;
+    bool leido = lector.mapeado() ? lector.leerTodo(tramo) : lector.leer(LectorEntrada::TAM_BUFFER, tramo);
+    if (leido) return ETAPA_OK;
+    etapa.errorLectura = errno;
+    return ETAPA_ERROR_LECTURA;
+}
+
+// Pasa toda la entrada de la etapa por su códec. push() toma menos de lo entregado cuando el
+// códec tiene mucha salida pendiente: se vacía y se sigue con el resto.
+ResultadoEtapa procesarEtapa(Etapa& etapa, LectorEntrada& lector, std::ostream& archivo) {
+    std::vector<unsigned char> buffer(etapa.salida ? 0 : TAM_SALIDA);
+    for (;;) {
+        Tramo tramo;
+        ResultadoEtapa resultado = siguienteTramo(etapa, lector, tramo);
+        if (resultado != ETAPA_OK) return resultado;
+        if (tramo.tamano == 0) break;
+
+        size_t usados = 0;
+        while (usados < tramo.tamano) {
+            size_t n = etapa.flujo->push(tramo.datos + usados, tramo.tamano - usados);
+            if (etapa.flujo->error()) return ETAPA_ERROR_CODEC;
+            usados += n;
+            if (etapa.entrada) etapa.entrada->liberar(n);
+            else lector.descartarHasta(tramo.datos + usados);
+            resultado = vaciar(etapa, archivo, buffer);
+            if (resultado != ETAPA_OK) return resultado;
+        }
+    }
+
+    bool completo = etapa.flujo->flush();
+    ResultadoEtapa resultado = vaciar(etapa, archivo, buffer);
+    if (resultado != ETAPA_OK) return resultado;
+    if (!completo) return ETAPA_ERROR_CODEC;
+    if (etapa.salida) etapa.salida->cerrar();
+    return ETAPA_OK;
+}
+
+// Corre una etapa; si falla, corta los anillos de los dos lados para que las vecinas no se
+// queden esperando, y el corte se propaga al resto de la cadena
+void ejecutarEtapa(Etapa& etapa, LectorEntrada& lector, std::ostream& archivo) {
+    etapa.resultado = procesarEtapa(etapa, lector, archivo);
+    if (etapa.resultado != ETAPA_OK) {
+        if (etapa.entrada) etapa.entrada->abortar();
+        if (etapa.salida) etapa.salida->abortar();
+    }
+}
+
+// Arma la cadena con los códecs ya creados y la ejecuta con un hilo por etapa (la primera en el
+// hilo que llama). Informa el error de la primera etapa que falló por sí misma.
+bool ejecutarCadena(std::vector<Etapa>& etapas, LectorEntrada& lector, std::ostream& archivo,
+                    const char* errorLectura, const std::string& nombreSalida) {
+    std::vector<std::unique_ptr<Anillo> > anillos;
+    for (size_t i = 0; i + 1 < etapas.size(); i++) {
+        anillos.push_back(std::unique_ptr<Anillo>(new Anillo(TAM_ANILLO)));
+        etapas[i].salida = anillos.back().get();
+        etapas[i + 1].entrada = anillos.back().get();
+    }
+
+    std::vector<std::thread> hilos;
+    for (size_t i = 1; i < etapas.size(); i++) {
+        hilos.push_back(std::thread(ejecutarEtapa, std::ref(etapas[i]), std::ref(lector), std::ref(archivo)));
+    }
+    ejecutarEtapa(etapas[0], lector, archivo);
+    for (size_t i = 0; i < hilos.size(); i++) hilos[i].join();
+
+    for (size_t i = 0; i < etapas.size(); i++) {
+        switch (etapas[i].resultado) {
+        case ETAPA_ERROR_LECTURA:
+            std::cerr << errorLectura << ": " << strerror(etapas[i].errorLectura) << std::endl;
+            return false;
+        case ETAPA_ERROR_CODEC:
+            std::cerr << "Error en la etapa " << etapas[i].nombre << ": " << etapas[i].flujo->error() << std::endl;
+            return false;
+        case ETAPA_ERROR_ESCRITURA:
+            std::cerr << "Error: No se pudo escribir " << nombreSalida << std::endl;
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// Nombre del resultado cuando no se indica -o: al aplicar se agregan las extensiones de las
+// etapas y al deshacer se quitan; vacío si el archivo no termina en ellas
+std::string nombrePorDefecto(const std::string& archivo, const std::vector<DefinicionEtapa>& definiciones, bool codificar) {
+    std::string extensiones;
+    for (size_t i = 0; i < definiciones.size(); i++) extensiones += extension(definiciones[i]);
+    if (codificar) return archivo + extensiones;
+    if (archivo.size() <= extensiones.size() ||
+        archivo.compare(archivo.size() - extensiones.size(), extensiones.size(), extensiones) != 0) {
+        return "";
+    }
+    return archivo.substr(0, archivo.size() - extensiones.size());
+}
+
+// Aplica la cadena (codificar) o la deshace; con "-" va de la entrada estándar a la salida estándar
+bool procesarArchivo(const std::string& archivo, std::string nombreSalida, const std::vector<DefinicionEtapa>& definiciones,
+                     bool codificar, unsigned hilos, const uint32_t* clave) {
+    bool aSalidaEstandar = LectorEntrada::esFlujoEstandar(archivo) && nombreSalida.empty();
+    if (!aSalidaEstandar && nombreSalida.empty()) {
+        nombreSalida = nombrePorDefecto(archivo, definiciones, codificar);
+        if (nombreSalida.empty()) {
+            std::cerr << "Error: " << archivo << " no termina en las extensiones de las etapas; indique el resultado con -o" << std::endl;
+            return false;
+        }
+    }
+
+    LectorEntrada entrada;
+    if (!entrada.abrir(archivo)) {
+        perror("Error al abrir el archivo de entrada");
+        return false;
+    }
+
+    // Al deshacer, la última etapa aplicada es la primera en deshacerse
+    std::vector<Etapa> etapas(definiciones.size());
+    for (size_t i = 0; i < definiciones.size(); i++) {
+        const DefinicionEtapa& definicion = definiciones[codificar ? i : definiciones.size() - 1 - i];
+        etapas[i].nombre = definicion.nombre;
+        etapas[i].flujo.reset(crearCodec(definicion, codificar, hilos, clave));
+        etapas[i].entrada = etapas[i].salida = nullptr;
+        etapas[i].resultado = ETAPA_OK;
+        etapas[i].errorLectura = 0;
+        if (!etapas[i].flujo) {
+            std::cerr << "Error: No hay memoria suficiente" << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream archivoSalida;
+    std::ostream& salida = aSalidaEstandar ? std::cout : archivoSalida;
+    if (!aSalidaEstandar) {
+        archivoSalida.open(nombreSalida, std::ios::binary);
+        if (!archivoSalida) {
+            perror("Error al crear el archivo de salida");
+            return false;
+        }
+    }
+    std::string descripcionSalida = aSalidaEstandar ? "la salida estándar" : nombreSalida;
+
+    bool exito = ejecutarCadena(etapas, entrada, salida, "Error al leer el archivo de entrada", descripcionSalida);
+    entrada.cerrar();
+    if (exito && !salida.flush()) {
+        std::cerr << "Error: No se pudo escribir " << descripcionSalida << std::endl;
+        exito = false;
+    }
+    if (!aSalidaEstandar) {
+        archivoSalida.close();
+        if (exito && !archivoSalida) {
+            std::cerr << "Error: No se pudo escribir " << descripcionSalida << std::endl;
+            exito = false;
+        }
+        // No dejar un resultado a medias, salvo que -o apunte a algo que no es un archivo común
+        struct stat info;
+        if (!exito && stat(nombreSalida.c_str(), &info) == 0 && S_ISREG(info.st_mode)) std::remove(nombreSalida.c_str());
+    }
+    if (exito && !aSalidaEstandar) std::cout << "Archivo procesado con éxito: " << nombreSalida << std::endl;
+    return exito;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        mostrarAyuda();
+        return 1;
+    }
+
+    std::string operacion, archivo, nombreSalida;
+    std::string lista = "lzw,xor";
+    const char* archivoClave = nullptr;
+    long hilos = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string opcion = argv[i];
+        if (opcion == "-h" || opcion == "--help") {
+            mostrarAyuda();
+            return 0;
+        } else if (opcion == "-v" || opcion == "--version") {
+            mostrarVersion();
+            return 0;
+        } else if ((opcion == "-c" || opcion == "--compress" || opcion == "-x" || opcion == "--decompress") && i + 1 < argc) {
+            operacion = opcion == "-c" || opcion == "--compress" ? "c" : "x";
+            archivo = argv[++i];
+        } else if ((opcion == "-e" || opcion == "--etapas") && i + 1 < argc) {
+            lista = argv[++i];
+        } else if (opcion == "-k" && i + 1 < argc) {
+            archivoClave = argv[++i];
+        } else if (opcion == "-o" && i + 1 < argc) {
+            nombreSalida = argv[++i];
+        } else if ((opcion == "-t" || opcion == "--threads") && i + 1 < argc && leerNumero(argv[i + 1], hilos)) {
+            i++;
+        } else {
+            std::cerr << "Opción no reconocida. Use -h o --help para obtener ayuda." << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<DefinicionEtapa> definiciones;
+    if (!leerEtapas(lista, definiciones)) return 1;
+    if (operacion.empty()) {
+        std::cerr << "Error: Debe indicar -c o -x con el nombre del archivo" << std::endl;
+        return 1;
+    }
+
+    uint32_t clave[8];
+    bool conClave = false;
+    for (size_t i = 0; i < definiciones.size(); i++) conClave = conClave || definiciones[i].tipo == ETAPA_CHACHA;
+    if (conClave && !cargarClave(archivoClave, clave)) return 1;
+
+    bool exito = procesarArchivo(archivo, nombreSalida, definiciones, operacion == "c", static_cast<unsigned>(hilos),
+                                 conClave ? clave : nullptr);
+    return exito ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+#include "cifrado.h"
+#include "interno.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/random.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define XOR_SIMD 1
+#endif
+
+namespace codec {
+
+// Kernels de XOR con la clave: cada uno avanza de a bloques tan grandes como pueda
+// y deja la cola que no completa un bloque al kernel más chico.
+static void xor_scalar(unsigned char *data, size_t size, unsigned char key) {
+    // 8 bytes por paso con la clave repetida en una palabra
+    const uint64_t key64 = 0x0101010101010101ULL * key;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        word ^= key64;
+        memcpy(data + i, &word, 8);
+    }
+    for (; i < size; i++) {
+        data[i] ^= key;
+    }
+}
+
+#ifdef XOR_SIMD
+__attribute__((target("sse2")))
+static void xor_sse2(unsigned char *data, size_t size, unsigned char key) {
+    const __m128i k = _mm_set1_epi8(static_cast<char>(key));
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_xor_si128(v, k));
+    }
+    xor_scalar(data + i, size - i, key);
+}
+
+__attribute__((target("avx2")))
+static void xor_avx2(unsigned char *data, size_t size, unsigned char key) {
+    const __m256i k = _mm256_set1_epi8(static_cast<char>(key));
+    size_t i = 0;
+    // 64 bytes por paso: dos registros independientes por vuelta
+    for (; i + 64 <= size; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), _mm256_xor_si256(a, k));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i + 32), _mm256_xor_si256(b, k));
+    }
+    if (i + 32 <= size) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), _mm256_xor_si256(a, k));
+        i += 32;
+    }
+    xor_sse2(data + i, size - i, key);
+}
+#endif
+
+xor_kernel select_xor_kernel(const char **name) {
+#ifdef XOR_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return xor_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return xor_sse2;
+    }
+#endif
+    *name = "escalar";
+    return xor_scalar;
+}
+
+// ChaCha20 (variante original de Bernstein: contador de bloque de 64 bits y nonce de 64 bits).
+// Cada bloque de 64 bytes de flujo depende solo de la clave, el nonce y su número, así que
+// cualquier posición del archivo se puede cifrar sin procesar lo anterior.
+#define CHACHA_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define CHACHA_QR(a, b, c, d)                                \
+    a += b; d ^= a; d = CHACHA_ROTL(d, 16);                  \
+    c += d; b ^= c; b = CHACHA_ROTL(b, 12);                  \
+    a += b; d ^= a; d = CHACHA_ROTL(d, 8);                   \
+    c += d; b ^= c; b = CHACHA_ROTL(b, 7);
+
+static const uint32_t CHACHA_CONSTANTS[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};  // "expand 32-byte k"
+
+static void chacha_block(const uint32_t key[8], uint64_t nonce, uint64_t block, unsigned char out[64]) {
+    uint32_t input[16] = {CHACHA_CONSTANTS[0], CHACHA_CONSTANTS[1], CHACHA_CONSTANTS[2], CHACHA_CONSTANTS[3],
+                          key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+                          static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32),
+                          static_cast<uint32_t>(nonce), static_cast<uint32_t>(nonce >> 32)};
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+    for (int round = 0; round < 10; round++) {  // 20 rondas: 10 dobles (columnas y diagonales)
+        CHACHA_QR(x[0], x[4], x[8], x[12]);
+        CHACHA_QR(x[1], x[5], x[9], x[13]);
+        CHACHA_QR(x[2], x[6], x[10], x[14]);
+        CHACHA_QR(x[3], x[7], x[11], x[15]);
+        CHACHA_QR(x[0], x[5], x[10], x[15]);
+        CHACHA_QR(x[1], x[6], x[11], x[12]);
+        CHACHA_QR(x[2], x[7], x[8], x[13]);
+        CHACHA_QR(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) {
+        uint32_t word = x[i] + input[i];
+        out[4 * i] = static_cast<unsigned char>(word);
+        out[4 * i + 1] = static_cast<unsigned char>(word >> 8);
+        out[4 * i + 2] = static_cast<unsigned char>(word >> 16);
+        out[4 * i + 3] = static_cast<unsigned char>(word >> 24);
+    }
+}
+
+// Kernels de flujo: aplican el XOR con el flujo desde el comienzo del bloque 'block'. Igual que
+// los de XOR, cada uno deja a la versión más chica lo que no completa su paso.
+static void chacha_scalar(const uint32_t key[8], uint64_t nonce, uint64_t block, unsigned char *data, size_t size) {
+    unsigned char stream[64];
+    while (size > 0) {
+        chacha_block(key, nonce, block++, stream);
+        size_t n = std::min<size_t>(size, 64);
+        for (size_t i = 0; i < n; i++) data[i] ^= stream[i];
+        data += n;
+        size -= n;
+    }
+}
+
+#ifdef XOR_SIMD
+// Las versiones vectoriales calculan varios bloques a la vez, uno por carril: cada registro
+// tiene la misma palabra del estado de 4 (SSE2) u 8 (AVX2) bloques consecutivos
+#define CHACHA_ROTL_SSE2(v, n) _mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+#define CHACHA_QR_SSE2(a, b, c, d)                                                   \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = CHACHA_ROTL_SSE2(d, 16);   \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = CHACHA_ROTL_SSE2(b, 12);   \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = CHACHA_ROTL_SSE2(d, 8);    \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = CHACHA_ROTL_SSE2(b, 7);
+
+// Traspone 4 palabras consecutivas del estado de 4 bloques y las aplica a los 16 bytes
+// correspondientes de cada bloque, a partir de 'out'
+__attribute__((target("sse2")))
+static void chacha_store_sse2(const __m128i *x, unsigned char *out) {
+    __m128i t0 = _mm_unpacklo_epi32(x[0], x[1]), t1 = _mm_unpackhi_epi32(x[0], x[1]);
+    __m128i t2 = _mm_unpacklo_epi32(x[2], x[3]), t3 = _mm_unpackhi_epi32(x[2], x[3]);
+    __m128i rows[4] = {_mm_unpacklo_epi64(t0, t2), _mm_unpackhi_epi64(t0, t2),
+                       _mm_unpacklo_epi64(t1, t3), _mm_unpackhi_epi64(t1, t3)};
+    for (int b = 0; b < 4; b++) {
+        __m128i *p = reinterpret_cast<__m128i *>(out + 64 * b);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), rows[b]));
+    }
+}
+
+__attribute__((target("sse2")))
+static void chacha_sse2(const uint32_t key[8], uint64_t nonce, uint64_t block, unsigned char *data, size_t size) {
+    for (; size >= 256; data += 256, size -= 256, block += 4) {
+        __m128i input[16], x[16];
+        for (int i = 0; i < 4; i++) input[i] = _mm_set1_epi32(static_cast<int>(CHACHA_CONSTANTS[i]));
+        for (int i = 0; i < 8; i++) input[4 + i] = _mm_set1_epi32(static_cast<int>(key[i]));
+        uint32_t low[4], high[4];
+        for (int lane = 0; lane < 4; lane++) {
+            low[lane] = static_cast<uint32_t>(block + lane);
+            high[lane] = static_cast<uint32_t>((block + lane) >> 32);
+        }
+        input[12] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(low));
+        input[13] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(high));
+        input[14] = _mm_set1_epi32(static_cast<int>(nonce));
+        input[15] = _mm_set1_epi32(static_cast<int>(nonce >> 32));
+        for (int i = 0; i < 16; i++) x[i] = input[i];
+        for (int round = 0; round < 10; round++) {
+            CHACHA_QR_SSE2(x[0], x[4], x[8], x[12]);
+            CHACHA_QR_SSE2(x[1], x[5], x[9], x[13]);
+            CHACHA_QR_SSE2(x[2], x[6], x[10], x[14]);
+            CHACHA_QR_SSE2(x[3], x[7], x[11], x[15]);
+            CHACHA_QR_SSE2(x[0], x[5], x[10], x[15]);
+            CHACHA_QR_SSE2(x[1], x[6], x[11], x[12]);
+            CHACHA_QR_SSE2(x[2], x[7], x[8], x[13]);
+            CHACHA_QR_SSE2(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; i++) x[i] = _mm_add_epi32(x[i], input[i]);
+        for (int i = 0; i < 4; i++) chacha_store_sse2(x + 4 * i, data + 16 * i);
+    }
+    chacha_scalar(key, nonce, block, data, size);
+}
+
+// Las rotaciones de 16 y 8 bits son permutaciones de bytes: un solo shuffle en lugar de dos
+// desplazamientos y un or
+#define CHACHA_ROTL_AVX2(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+#define CHACHA_QR_AVX2(a, b, c, d)                                                                      \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16);         \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CHACHA_ROTL_AVX2(b, 12);               \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8);          \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CHACHA_ROTL_AVX2(b, 7);
+
+// Traspone 8 palabras consecutivas del estado de 8 bloques y las aplica a los 32 bytes
+// correspondientes de cada bloque, a partir de 'out'
+__attribute__((target("avx2")))
+static void chacha_store_avx2(const __m256i *x, unsigned char *out) {
+    __m256i t[8], u[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(x[i], x[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(x[i], x[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    // La mitad baja de cada registro tiene los bloques 0 a 3 y la alta los bloques 4 a 7
+    for (int b = 0; b < 4; b++) {
+        __m256i *low = reinterpret_cast<__m256i *>(out + 64 * b);
+        __m256i *high = reinterpret_cast<__m256i *>(out + 64 * (b + 4));
+        _mm256_storeu_si256(low, _mm256_xor_si256(_mm256_loadu_si256(low), _mm256_permute2x128_si256(u[b], u[b + 4], 0x20)));
+        _mm256_storeu_si256(high, _mm256_xor_si256(_mm256_loadu_si256(high), _mm256_permute2x128_si256(u[b], u[b + 4], 0x31)));
+    }
+}
+
+__attribute__((target("avx2")))
+static void chacha_avx2(const uint32_t key[8], uint64_t nonce, uint64_t block, unsigned char *data, size_t size) {
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    for (; size >= 512; data += 512, size -= 512, block += 8) {
+        __m256i input[16], x[16];
+        for (int i = 0; i < 4; i++) input[i] = _mm256_set1_epi32(static_cast<int>(CHACHA_CONSTANTS[i]));
+        for (int i = 0; i < 8; i++) input[4 + i] = _mm256_set1_epi32(static_cast<int>(key[i]));
+        uint32_t low[8], high[8];
+        for (int lane = 0; lane < 8; lane++) {
+            low[lane] = static_cast<uint32_t>(block + lane);
+            high[lane] = static_cast<uint32_t>((block + lane) >> 32);
+        }
+        input[12] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(low));
+        input[13] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(high));
+        input[14] = _mm256_set1_epi32(static_cast<int>(nonce));
+        input[15] = _mm256_set1_epi32(static_cast<int>(nonce >> 32));
+        for (int i = 0; i < 16; i++) x[i] = input[i];
+        for (int round = 0; round < 10; round++) {
+            CHACHA_QR_AVX2(x[0], x[4], x[8], x[12]);
+            CHACHA_QR_AVX2(x[1], x[5], x[9], x[13]);
+            CHACHA_QR_AVX2(x[2], x[6], x[10], x[14]);
+            CHACHA_QR_AVX2(x[3], x[7], x[11], x[15]);
+            CHACHA_QR_AVX2(x[0], x[5], x[10], x[15]);
+            CHACHA_QR_AVX2(x[1], x[6], x[11], x[12]);
+            CHACHA_QR_AVX2(x[2], x[7], x[8], x[13]);
+            CHACHA_QR_AVX2(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; i++) x[i] = _mm256_add_epi32(x[i], input[i]);
+        chacha_store_avx2(x, data);
+        chacha_store_avx2(x + 8, data + 32);
+    }
+    chacha_sse2(key, nonce, block, data, size);
+}
+#endif
+
+chacha_kernel select_chacha_kernel(const char **name) {
+#ifdef XOR_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return chacha_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return chacha_sse2;
+    }
+#endif
+    *name = "escalar";
+    return chacha_scalar;
+}
+
+void apply_cipher(const cipher &c, unsigned char *data, size_t size, uint64_t offset) {
+    if (!c.keystream) {
+        c.apply_xor(data, size, XOR_KEY);  // Aplicar XOR para encriptar/desencriptar
+        return;
+    }
+    // El bloque 0 del flujo se reserva para verificar la clave: los datos empiezan en el 1
+    uint64_t block = offset / 64 + KEYSTREAM_FIRST_BLOCK;
+    size_t skip = static_cast<size_t>(offset % 64);
+    if (skip > 0) {
+        // Comienzo a mitad de un bloque: se genera entero y se usa solo la parte que corresponde
+        unsigned char stream[64];
+        chacha_block(c.key, c.nonce, block++, stream);
+        size_t n = std::min(size, 64 - skip);
+        for (size_t i = 0; i < n; i++) data[i] ^= stream[skip + i];
+        data += n;
+        size -= n;
+    }
+    c.keystream(c.key, c.nonce, block, data, size);
+}
+
+// getrandom() puede devolver menos bytes de los pedidos si lo interrumpe una señal
+bool random_bytes(unsigned char *out, size_t size) {
+    while (size > 0) {
+        ssize_t n = getrandom(out, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Cabecera del modo con clave: "ENC", versión, nonce y los primeros 8 bytes del bloque 0 del
+// flujo, que los datos no usan. Al desencriptar permiten detectar una clave equivocada sin
+// revelar nada del flujo que cifra los datos.
+void keyed_header(const cipher &c, unsigned char header[KEYED_HEADER_SIZE]) {
+    memcpy(header, KEYED_MAGIC, 3);
+    header[3] = KEYED_VERSION;
+    for (int i = 0; i < 8; i++) header[4 + i] = static_cast<unsigned char>(c.nonce >> (8 * i));
+    unsigned char stream[64];
+    chacha_block(c.key, c.nonce, 0, stream);
+    memcpy(header + 12, stream, 8);
+}
+
+void init_cipher(cipher &c, const uint32_t *key) {
+    const char *kernel_name;
+    c = cipher();
+    c.apply_xor = select_xor_kernel(&kernel_name);
+    if (key) {
+        c.keystream = select_chacha_kernel(&kernel_name);
+        memcpy(c.key, key, sizeof(c.key));
+    }
+}
+
+header_status check_keyed_header(const unsigned char stored[KEYED_HEADER_SIZE], cipher &c) {
+    if (memcmp(stored, KEYED_MAGIC, 3) != 0 || stored[3] != KEYED_VERSION) return HEADER_MISSING;
+    unsigned char expected[KEYED_HEADER_SIZE];
+    c.nonce = 0;
+    for (int i = 0; i < 8; i++) c.nonce |= static_cast<uint64_t>(stored[4 + i]) << (8 * i);
+    keyed_header(c, expected);
+    return memcmp(expected, stored, KEYED_HEADER_SIZE) == 0 ? HEADER_OK : HEADER_WRONG_KEY;
+}
+
+bool parse_key(const char *text, size_t size, uint32_t key[8]) {
+    unsigned char bytes[32];
+    if (size == 32) {
+        memcpy(bytes, text, 32);
+    } else {
+        while (size > 0 && isspace(static_cast<unsigned char>(text[size - 1]))) size--;
+        if (size != 64) return false;
+        for (int i = 0; i < 32; i++) {
+            char digits[3] = {text[2 * i], text[2 * i + 1], '\0'};
+            if (!isxdigit(static_cast<unsigned char>(digits[0])) || !isxdigit(static_cast<unsigned char>(digits[1]))) {
+                return false;
+            }
+            bytes[i] = static_cast<unsigned char>(strtoul(digits, nullptr, 16));
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        key[i] = static_cast<uint32_t>(bytes[4 * i]) | static_cast<uint32_t>(bytes[4 * i + 1]) << 8 |
+                 static_cast<uint32_t>(bytes[4 * i + 2]) << 16 | static_cast<uint32_t>(bytes[4 * i + 3]) << 24;
+    }
+    return true;
+}
+
+
+// Códec de flujo: cifra lo recibido a continuación de lo anterior. En el modo con clave el
+// codificador empieza la salida con la cabecera y el decodificador la saca de la entrada.
+template <typename Interface>
+class cipher_stream : public StreamBase<Interface> {
+public:
+    cipher_stream(const Allocator &allocator, const cipher &c, bool read_header)
+        : StreamBase<Interface>(allocator), c(c), offset(0), header_used(read_header ? 0 : KEYED_HEADER_SIZE) {
+        if (c.keystream && !read_header) {
+            unsigned char header[KEYED_HEADER_SIZE];
+            keyed_header(c, header);
+            this->output.append(header, sizeof(header));
+        }
+    }
+
+protected:
+    size_t consume(const unsigned char *data, size_t size) override {
+        size_t used = 0;
+        if (header_used < KEYED_HEADER_SIZE) {
+            used = std::min(size, size_t(KEYED_HEADER_SIZE - header_used));
+            memcpy(header + header_used, data, used);
+            header_used += used;
+            if (header_used == KEYED_HEADER_SIZE && !check_header()) return size;
+        }
+        size_t pending = this->output.pending();
+        size_t n = pending < OUTPUT_LIMIT ? std::min(size - used, OUTPUT_LIMIT - pending) : 0;
+        if (n == 0) return used;  // Todo fue cabecera, o la salida está llena
+        unsigned char *out = this->output.reserve(n);
+        memcpy(out, data + used, n);
+        apply_cipher(c, out, n, offset);
+        this->output.commit(n);
+        offset += n;
+        return used + n;
+    }
+
+    void finish() override {
+        if (header_used < KEYED_HEADER_SIZE) this->fail("no fue encriptado con clave");
+    }
+
+    size_t objectSize() const override { return sizeof(*this); }
+
+private:
+    cipher c;
+    uint64_t offset;  // Posición en los datos, sin contar la cabecera
+    unsigned char header[KEYED_HEADER_SIZE];
+    size_t header_used;
+
+    bool check_header() {
+        switch (check_keyed_header(header, c)) {
+        case HEADER_MISSING:
+            this->fail("no fue encriptado con clave");
+            return false;
+        case HEADER_WRONG_KEY:
+            this->fail("la clave no corresponde");
+            return false;
+        default:
+            return true;
+        }
+    }
+};
+
+Encoder *newXorEncoder(const Allocator *allocator) {
+    cipher c;
+    init_cipher(c, nullptr);
+    return create<cipher_stream<Encoder> >(allocator, c, false);
+}
+
+Decoder *newXorDecoder(const Allocator *allocator) {
+    cipher c;
+    init_cipher(c, nullptr);
+    return create<cipher_stream<Decoder> >(allocator, c, false);
+}
+
+Encoder *newChaChaEncoder(const uint32_t key[8], const Allocator *allocator) {
+    cipher c;
+    init_cipher(c, key);
+    unsigned char nonce[8];
+    if (!random_bytes(nonce, sizeof(nonce))) return nullptr;
+    for (int i = 0; i < 8; i++) c.nonce |= static_cast<uint64_t>(nonce[i]) << (8 * i);
+    return create<cipher_stream<Encoder> >(allocator, c, false);
+}
+
+Decoder *newChaChaDecoder(const uint32_t key[8], const Allocator *allocator) {
+    cipher c;
+    init_cipher(c, key);
+    return create<cipher_stream<Decoder> >(allocator, c, true);
+}
+
+}  // namespace codec
@@ -0,0 +1,61 @@
+#ifndef CODEC_CIFRADO_H
+#define CODEC_CIFRADO_H
+
+// Cifrado del encriptador por posición: cualquier tramo de un archivo se puede cifrar sin
+// procesar lo anterior. Lo usan el encriptador, que reparte un archivo entre hilos, y los
+// códecs de flujo de XOR y ChaCha20 de codec.h.
+
+#include <cstddef>
+#include <cstdint>
+
+#define XOR_KEY 0x5A  // Clave para encriptación y desencriptación
+#define KEYED_MAGIC "ENC"
+#define KEYED_VERSION 1
+#define KEYED_HEADER_SIZE 20  // "ENC", versión, nonce (8 bytes) y verificación de la clave (8 bytes)
+#define KEYSTREAM_FIRST_BLOCK 1
+#define KEY_ENV "ENCRIPTADOR_CLAVE"  // Variable de entorno con la clave de ChaCha20, si no se usa -k
+
+namespace codec {
+
+typedef void (*xor_kernel)(unsigned char *data, size_t size, unsigned char key);
+typedef void (*chacha_kernel)(const uint32_t key[8], uint64_t nonce, uint64_t block, unsigned char *data, size_t size);
+
+// Eligen el kernel una sola vez según lo que soporte el procesador en ejecución; 'name' queda
+// con su nombre ("avx2", "sse2" o "escalar")
+xor_kernel select_xor_kernel(const char **name);
+chacha_kernel select_chacha_kernel(const char **name);
+
+// Cómo se transforma un archivo: XOR con la clave fija, o el flujo de ChaCha20 con la clave del
+// usuario y el nonce de ese archivo
+struct cipher {
+    xor_kernel apply_xor;
+    chacha_kernel keystream;      // nullptr en el modo XOR
+    uint32_t key[8];
+    uint64_t nonce;
+};
+
+// Prepara 'c' con los kernels más rápidos: modo XOR sin 'key', ChaCha20 con ella (nonce en 0)
+void init_cipher(cipher &c, const uint32_t *key);
+
+// Aplica el cifrado a 'size' bytes que están en la posición 'offset' de los datos del archivo
+void apply_cipher(const cipher &c, unsigned char *data, size_t size, uint64_t offset);
+
+// Bytes al azar del kernel, para los nonces
+bool random_bytes(unsigned char *out, size_t size);
+
+// Cabecera del modo con clave para el nonce y la clave de 'c'
+void keyed_header(const cipher &c, unsigned char header[KEYED_HEADER_SIZE]);
+
+enum header_status { HEADER_OK, HEADER_MISSING, HEADER_WRONG_KEY };
+
+// Revisa la cabecera leída de un archivo encriptado con clave, completa el nonce de 'c' y
+// verifica la clave
+header_status check_keyed_header(const unsigned char stored[KEYED_HEADER_SIZE], cipher &c);
+
+// Clave de ChaCha20: 32 bytes tal cual, o 64 dígitos hexadecimales (con espacios o un salto de
+// línea al final, como los deja un editor o 'openssl rand -hex 32')
+bool parse_key(const char *text, size_t size, uint32_t key[8]);
+
+}  // namespace codec
+
+#endif
@@ -0,0 +1,23 @@
+#include "interno.h"
+#include <cstdlib>
+
+namespace codec {
+
+static void* mallocAllocate(size_t size, void*) {
+    return malloc(size);
+}
+
+static void mallocRelease(void* pointer, size_t, void*) {
+    free(pointer);
+}
+
+const Allocator& defaultAllocator() {
+    static const Allocator allocator = {mallocAllocate, mallocRelease, nullptr};
+    return allocator;
+}
+
+void destroy(Stream* stream) {
+    if (stream) stream->release();
+}
+
+}  // namespace codec
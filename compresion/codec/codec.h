@@ -0,0 +1,121 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// libcodec: los códecs de lzw, huffman y del encriptador detrás de una misma interfaz de flujo,
+// sin archivos, salida estándar ni exit(). Se entregan bytes con push(), se retira el resultado
+// con pull() y se marca el fin de la entrada con flush():
+//
+//     while (quedan datos) {
+//         usados += codificador->push(datos + usados, tamano - usados);
+//         while ((n = codificador->pull(buffer, sizeof(buffer))) > 0) escribir(buffer, n);
+//     }
+//     codificador->flush();
+//     while ((n = codificador->pull(buffer, sizeof(buffer))) > 0) escribir(buffer, n);
+//
+// Los formatos son los mismos que escriben y leen los programas: un archivo .lzw, .huff o
+// encriptado con clave se puede procesar con cualquiera de los dos.
+
+// Ancho de los códigos LZW: empieza en LZW_MIN_BITS y crece hasta el máximo elegido al comprimir
+#define LZW_MIN_BITS 9
+#define LZW_MIN_MAX_BITS 12
+#define LZW_MAX_MAX_BITS 16
+#define LZW_DEFAULT_MAX_BITS 12
+
+// Bloques de Huffman: tamaño por defecto y límites aceptados
+#define HUFFMAN_DEFAULT_BLOCK_SIZE (size_t(1) << 20)
+#define HUFFMAN_MIN_BLOCK_SIZE (size_t(1) << 12)
+#define HUFFMAN_MAX_BLOCK_SIZE (size_t(1) << 29)
+
+namespace codec {
+
+// De dónde sale la memoria de los códecs: el propio objeto, las tablas, los bloques y la salida
+// pendiente. Sin asignador se usan malloc y free. Con threads != 1 en Huffman también lo llaman
+// los hilos del códec, así que tiene que poder usarse desde varios hilos a la vez. Las
+// estructuras temporales de tamaño fijo (un árbol de Huffman de 256 hojas, el diccionario del
+// formato LZW v1) usan new como el resto del programa.
+struct Allocator {
+    void* (*allocate)(size_t size, void* context);  // nullptr si no hay memoria
+    void (*release)(void* pointer, size_t size, void* context);
+    void* context;
+};
+
+// Interfaz común a codificadores y decodificadores
+class Stream {
+public:
+    // Consume bytes de la entrada y devuelve cuántos tomó. Toma menos de 'size' (hasta 0) cuando
+    // ya tiene suficiente salida pendiente: hay que retirarla con pull() y volver a entregar el
+    // resto. Así la memoria queda acotada aunque se entregue un archivo entero de una vez. Los
+    // datos solo se leen durante la llamada; no hace falta que sigan existiendo después.
+    virtual size_t push(const unsigned char* data, size_t size) = 0;
+
+    // Copia hasta 'capacity' bytes de salida; 0 cuando no queda nada pendiente
+    virtual size_t pull(unsigned char* out, size_t capacity) = 0;
+
+    // Marca el fin de la entrada y produce lo que queda; después se sigue con pull() hasta que
+    // devuelva 0. Devuelve false si los datos están truncados o son inválidos.
+    virtual bool flush() = 0;
+
+    // Bytes de salida que esperan un pull()
+    virtual size_t pending() const = 0;
+
+    // Descripción del primer error (datos inválidos, memoria agotada), o nullptr. Con un error
+    // push() descarta lo que recibe y flush() devuelve false.
+    virtual const char* error() const = 0;
+
+protected:
+    virtual ~Stream() {}
+
+    // Destruye el objeto y devuelve su memoria al asignador con el que se creó
+    virtual void release() = 0;
+    friend void destroy(Stream* stream);
+};
+
+class Encoder : public Stream {
+protected:
+    ~Encoder() {}
+};
+
+class Decoder : public Stream {
+protected:
+    ~Decoder() {}
+};
+
+// Libera un códec creado por las funciones de abajo (nullptr no hace nada)
+void destroy(Stream* stream);
+
+struct Deleter {
+    void operator()(Stream* stream) const { destroy(stream); }
+};
+typedef std::unique_ptr<Encoder, Deleter> EncoderPtr;
+typedef std::unique_ptr<Decoder, Deleter> DecoderPtr;
+
+// Las funciones que crean códecs devuelven nullptr si los parámetros no son válidos o no hay
+// memoria. 'allocator' puede ser nullptr; si no, tiene que seguir existiendo mientras viva el códec.
+
+// LZW (formato v2). El decodificador también lee el formato v1, que no tiene cabecera: en ese
+// caso junta toda la entrada y la descomprime en flush().
+Encoder* newLzwEncoder(int maxBits = LZW_DEFAULT_MAX_BITS, const Allocator* allocator = nullptr);
+Decoder* newLzwDecoder(const Allocator* allocator = nullptr);
+
+// Huffman por bloques (formato v3). 'threads' hilos comprimen o descomprimen tandas de bloques
+// en paralelo (0 = todos los núcleos). El decodificador también lee las versiones 1 y 2, que no
+// tienen bloques: esas se juntan completas y se descomprimen en flush().
+Encoder* newHuffmanEncoder(size_t blockSize = HUFFMAN_DEFAULT_BLOCK_SIZE, unsigned threads = 1,
+                           const Allocator* allocator = nullptr);
+Decoder* newHuffmanDecoder(unsigned threads = 1, const Allocator* allocator = nullptr);
+
+// Cifrado del encriptador. XOR con la clave fija: encriptar y desencriptar es lo mismo. ChaCha20
+// con una clave de 8 palabras: el codificador elige un nonce al azar y escribe la cabecera del
+// modo con clave; el decodificador la lee y falla si la clave no corresponde.
+Encoder* newXorEncoder(const Allocator* allocator = nullptr);
+Decoder* newXorDecoder(const Allocator* allocator = nullptr);
+Encoder* newChaChaEncoder(const uint32_t key[8], const Allocator* allocator = nullptr);
+Decoder* newChaChaDecoder(const uint32_t key[8], const Allocator* allocator = nullptr);
+
+}  // namespace codec
+
+#endif
@@ -0,0 +1,868 @@
+#include "interno.h"
+#include "../comun/pool_hilos.h"
+#include <atomic>
+#include <queue>
+
+namespace codec {
+
+// Formato del archivo .huff: "HUF", versión, longitudes de código de los 256 caracteres
+// empaquetadas de a dos por byte, relleno y datos. Los archivos de la versión 1 no tienen
+// la firma y empiezan directamente con la cantidad de caracteres.
+const char MAGIA[3] = {'H', 'U', 'F'};
+const unsigned char VERSION_FORMATO = 2;
+const int TAM_TABLA_LONGITUDES = 128;
+
+// Versión 3 (por bloques): tras "HUF" 3 va el tamaño de bloque (uint32). Cada bloque se comprime
+// por separado con su propia tabla: bytes originales (uint32), bytes de datos (uint32), longitudes,
+// relleno y datos. Un bloque con 0 bytes originales marca el final; después va el índice con el
+// desplazamiento de cada bloque (uint64) y la cantidad de bloques (uint64).
+const unsigned char VERSION_BLOQUES = 3;
+const int TAM_CABECERA_BLOQUE = 4 + 4 + TAM_TABLA_LONGITUDES + 1;
+
+// Longitud máxima de un código; cabe en medio byte de la cabecera
+const int LONGITUD_MAXIMA = 15;
+
+// Definición de la estructura del nodo del árbol de Huffman
+struct Nodo {
+    unsigned char caracter;
+    uint64_t frecuencia;
+    Nodo* izquierda;
+    Nodo* derecha;
+
+    Nodo(unsigned char c, uint64_t f, Nodo* izq = nullptr, Nodo* der = nullptr)
+        : caracter(c), frecuencia(f), izquierda(izq), derecha(der) {}
+
+    ~Nodo() {
+        delete izquierda;
+        delete derecha;
+    }
+
+    // Las hojas se reconocen por no tener hijos; el caracter '\0' es un caracter más
+    bool esHoja() const { return !izquierda && !derecha; }
+};
+
+// Comparador para la cola de prioridad, ordena por frecuencia ascendente
+struct Comparar {
+    bool operator()(Nodo* a, Nodo* b) {
+        return a->frecuencia > b->frecuencia;
+    }
+};
+
+// Construcción del árbol de Huffman basado en las frecuencias (nullptr si no hay caracteres)
+Nodo* construirArbolHuffman(const uint64_t frecuencias[256]) {
+    std::priority_queue<Nodo*, std::vector<Nodo*>, Comparar> cola;
+    for (int c = 0; c < 256; c++)
+        if (frecuencias[c] > 0) cola.push(new Nodo(static_cast<unsigned char>(c), frecuencias[c]));
+    if (cola.empty()) return nullptr;
+    while (cola.size() > 1) {
+        Nodo* izquierda = cola.top(); cola.pop();
+        Nodo* derecha = cola.top(); cola.pop();
+        Nodo* padre = new Nodo('\0', izquierda->frecuencia + derecha->frecuencia, izquierda, derecha);
+        cola.push(padre);
+    }
+    return cola.top();
+}
+
+// Longitud del código de cada caracter = profundidad de su hoja en el árbol
+void calcularLongitudes(const Nodo* raiz, int profundidad, int longitudes[256]) {
+    if (!raiz) return;
+    if (raiz->esHoja()) {
+        // Un archivo con un solo caracter distinto igual necesita un bit por caracter
+        longitudes[raiz->caracter] = profundidad > 0 ? profundidad : 1;
+        return;
+    }
+    calcularLongitudes(raiz->izquierda, profundidad + 1, longitudes);
+    calcularLongitudes(raiz->derecha, profundidad + 1, longitudes);
+}
+
+// Recorta los códigos a LONGITUD_MAXIMA bits. Los que quedaron cortos dejan de cumplir la
+// desigualdad de Kraft, así que se alargan los códigos más largos por debajo del máximo
+// (empezando por el caracter menos frecuente) hasta volver a cumplirla.
+void limitarLongitudes(int longitudes[256], const uint64_t frecuencias[256]) {
+    bool excede = false;
+    for (int c = 0; c < 256; c++) excede = excede || longitudes[c] > LONGITUD_MAXIMA;
+    if (!excede) return;
+
+    const long capacidad = 1L << LONGITUD_MAXIMA;
+    long kraft = 0;
+    for (int c = 0; c < 256; c++) {
+        if (longitudes[c] > LONGITUD_MAXIMA) longitudes[c] = LONGITUD_MAXIMA;
+        if (longitudes[c] > 0) kraft += 1L << (LONGITUD_MAXIMA - longitudes[c]);
+    }
+
+    while (kraft > capacidad) {
+        int elegido = -1;
+        for (int c = 0; c < 256; c++) {
+            if (longitudes[c] == 0 || longitudes[c] == LONGITUD_MAXIMA) continue;
+            if (elegido < 0 || longitudes[c] > longitudes[elegido] ||
+                (longitudes[c] == longitudes[elegido] && frecuencias[c] < frecuencias[elegido]))
+                elegido = c;
+        }
+        kraft -= 1L << (LONGITUD_MAXIMA - longitudes[elegido] - 1);
+        longitudes[elegido]++;
+    }
+
+    // Si sobró espacio de códigos, se aprovecha acortando primero los caracteres más frecuentes
+    int orden[256];
+    for (int c = 0; c < 256; c++) orden[c] = c;
+    std::sort(orden, orden + 256, [&](int a, int b) { return frecuencias[a] > frecuencias[b]; });
+    for (int i = 0; i < 256 && longitudes[orden[i]] > 0; i++) {
+        int c = orden[i];
+        while (longitudes[c] > 1 && kraft + (1L << (LONGITUD_MAXIMA - longitudes[c])) <= capacidad) {
+            kraft += 1L << (LONGITUD_MAXIMA - longitudes[c]);
+            longitudes[c]--;
+        }
+    }
+}
+
+// Códigos canónicos: dentro de cada longitud se numeran en orden de caracter, así que
+// las longitudes bastan para reconstruirlos al descomprimir
+void asignarCodigosCanonicos(const int longitudes[256], uint64_t codigos[256]) {
+    int cantidad[LONGITUD_MAXIMA + 1] = {0};
+    for (int c = 0; c < 256; c++) cantidad[longitudes[c]]++;
+    cantidad[0] = 0;
+
+    uint64_t siguiente[LONGITUD_MAXIMA + 1] = {0};
+    uint64_t codigo = 0;
+    for (int l = 1; l <= LONGITUD_MAXIMA; l++) {
+        codigo = (codigo + cantidad[l - 1]) << 1;
+        siguiente[l] = codigo;
+    }
+    for (int c = 0; c < 256; c++) {
+        codigos[c] = longitudes[c] > 0 ? siguiente[longitudes[c]]++ : 0;
+    }
+}
+
+// Escritor de bits (el más significativo primero): cada código entra a un acumulador de 64 bits
+// y se vuelcan palabras completas de 32 bits al destino, que debe tener lugar para todos los bits
+class EscritorBits {
+public:
+    explicit EscritorBits(char* destino) : destino(destino), usados(0), acumulador(0), ocupados(0) {}
+
+    void escribir(uint64_t codigo, int longitud) {
+        // Con a lo más 31 bits pendientes y códigos de hasta LONGITUD_MAXIMA bits no se desborda
+        acumulador = (acumulador << longitud) | codigo;
+        ocupados += longitud;
+        if (ocupados >= 32) {
+            ocupados -= 32;
+            uint32_t palabra = __builtin_bswap32(static_cast<uint32_t>(acumulador >> ocupados));
+            memcpy(destino + usados, &palabra, 4);
+            usados += 4;
+        }
+    }
+
+    // Completa el último byte con ceros; devuelve la cantidad de bytes escritos
+    size_t terminar() {
+        while (ocupados > 0) {
+            int n = ocupados < 8 ? ocupados : 8;
+            ocupados -= n;
+            destino[usados++] = static_cast<char>(((acumulador >> ocupados) & ((1u << n) - 1)) << (8 - n));
+        }
+        return usados;
+    }
+
+private:
+    char* destino;
+    size_t usados;
+    uint64_t acumulador;  // Los bits pendientes son los 'ocupados' menos significativos
+    int ocupados;
+};
+
+// Lee enteros en el orden de bytes de la máquina, igual que la cabecera v1
+template <typename T>
+T leerEntero(const char* origen) {
+    T valor;
+    memcpy(&valor, origen, sizeof(T));
+    return valor;
+}
+
+// Resultado de comprimir un bloque: cabecera completa (tamaños, longitudes y relleno) y datos
+struct BloqueComprimido {
+    char cabecera[TAM_CABECERA_BLOQUE];
+    Vector<char> datos;
+
+    explicit BloqueComprimido(const Allocator* asignador) : cabecera(), datos(StlAllocator<char>(asignador)) {}
+};
+
+// Suma a 'frecuencias' las apariciones de cada caracter. Se cuenta en cuatro tablas
+// intercaladas para que bytes iguales seguidos (muy comunes en texto y registros) no
+// incrementen el mismo contador una y otra vez esperando a que termine la escritura anterior.
+void contarFrecuencias(const unsigned char* datos, size_t tamano, uint64_t frecuencias[256]) {
+    uint64_t tablas[4][256];
+    memset(tablas, 0, sizeof(tablas));
+
+    size_t i = 0;
+    for (; i + 8 <= tamano; i += 8) {
+        uint64_t palabra;
+        memcpy(&palabra, datos + i, 8);
+        tablas[0][palabra & 0xFF]++;
+        tablas[1][(palabra >> 8) & 0xFF]++;
+        tablas[2][(palabra >> 16) & 0xFF]++;
+        tablas[3][(palabra >> 24) & 0xFF]++;
+        tablas[0][(palabra >> 32) & 0xFF]++;
+        tablas[1][(palabra >> 40) & 0xFF]++;
+        tablas[2][(palabra >> 48) & 0xFF]++;
+        tablas[3][palabra >> 56]++;
+    }
+    for (; i < tamano; i++) tablas[0][datos[i]]++;
+
+    for (int c = 0; c < 256; c++) {
+        frecuencias[c] += tablas[0][c] + tablas[1][c] + tablas[2][c] + tablas[3][c];
+    }
+}
+
+// Comprime un bloque en memoria con su propia tabla de Huffman
+void comprimirBloque(const unsigned char* datos, size_t tamano, BloqueComprimido& bloque) {
+    // Contar las frecuencia de cada caracter
+    uint64_t frecuencias[256] = {0};
+    contarFrecuencias(datos, tamano, frecuencias);
+
+    // Construir el árbol de Huffman y sacar de él solo la longitud de cada código
+    Nodo* raiz = construirArbolHuffman(frecuencias);
+    int longitudCodigo[256] = {0};
+    calcularLongitudes(raiz, 0, longitudCodigo);
+    delete raiz;
+    limitarLongitudes(longitudCodigo, frecuencias);
+
+    uint64_t codigoBits[256];
+    asignarCodigosCanonicos(longitudCodigo, codigoBits);
+
+    uint64_t totalBits = 0;
+    for (int c = 0; c < 256; c++) totalBits += frecuencias[c] * longitudCodigo[c];
+
+    // Codificar escribiendo los bits directamente; el tamaño exacto se conoce de antemano
+    bloque.datos.resize((totalBits + 7) / 8);
+    EscritorBits escritor(bloque.datos.data());
+    for (size_t i = 0; i < tamano; i++) {
+        escritor.escribir(codigoBits[datos[i]], longitudCodigo[datos[i]]);
+    }
+    escritor.terminar();
+
+    // Cabecera: tamaños, longitudes empaquetadas de a dos por byte y relleno hasta múltiplo de 8
+    uint32_t bytesOriginales = static_cast<uint32_t>(tamano);
+    uint32_t bytesDatos = static_cast<uint32_t>(bloque.datos.size());
+    memcpy(bloque.cabecera, &bytesOriginales, 4);
+    memcpy(bloque.cabecera + 4, &bytesDatos, 4);
+    for (int c = 0; c < 256; c += 2) {
+        bloque.cabecera[8 + c / 2] = static_cast<char>((longitudCodigo[c] << 4) | longitudCodigo[c + 1]);
+    }
+    bloque.cabecera[TAM_CABECERA_BLOQUE - 1] = static_cast<char>((8 - totalBits % 8) % 8);
+}
+
+// Bits que resuelve de una sola consulta la tabla principal del decodificador
+const int BITS_TABLA = 11;
+
+// Lector de bits (el más significativo primero) con un acumulador de 64 bits.
+// Los bits pendientes quedan alineados a la izquierda; lo que falta se lee como ceros.
+// Lee directamente de los datos en memoria (el archivo mapeado o un bloque ya leído).
+class LectorBits {
+public:
+    LectorBits(const char* datos, size_t tamano, uint64_t totalBits)
+        : buffer(datos), posicion(0), tamano(tamano), bits(0), disponibles(0), restantes(totalBits) {}
+
+    // Completa el acumulador hasta tener al menos 57 bits (o hasta que se acaben los datos)
+    void rellenar() {
+        // Con 8 bytes a mano se cargan de una vez; los bits de más que entran al acumulador son
+        // los mismos que traerá la siguiente carga, así que el OR no los altera
+        if (tamano - posicion >= 8) {
+            uint64_t palabra;
+            memcpy(&palabra, buffer + posicion, 8);
+            bits |= __builtin_bswap64(palabra) >> disponibles;
+            int bytes = (63 - disponibles) >> 3;
+            posicion += bytes;
+            disponibles += bytes * 8;
+            return;
+        }
+        while (disponibles <= 56 && posicion < tamano) {
+            bits |= uint64_t(static_cast<unsigned char>(buffer[posicion++])) << (56 - disponibles);
+            disponibles += 8;
+        }
+    }
+
+    unsigned mirar(int n) const { return static_cast<unsigned>(bits >> (64 - n)); }
+
+    void consumir(int n) {
+        bits <<= n;
+        disponibles -= n;
+        restantes -= n;
+    }
+
+    int enAcumulador() const { return disponibles; }
+    uint64_t bitsRestantes() const { return restantes; }
+
+private:
+    const char* buffer;
+    size_t posicion;
+    size_t tamano;
+    uint64_t bits;
+    int disponibles;     // Bits válidos en el acumulador
+    uint64_t restantes;  // Bits de datos que quedan, sin contar el relleno
+};
+
+// Árbol de decodificación guardado en un arreglo; hijo = -1 si no existe
+struct NodoDecodificacion {
+    int hijo[2];
+    int simbolo;  // -1 en nodos internos
+};
+
+// Entrada de la tabla principal: un símbolo completo de 'longitud' bits,
+// o el nodo del árbol al que se llega tras BITS_TABLA bits si el código es más largo
+struct EntradaTabla {
+    int valor;          // Símbolo u índice de nodo
+    uint8_t longitud;   // 0 = patrón que no corresponde a ningún código
+    bool esHoja;
+};
+
+// Agrega un código de 'longitud' bits al árbol; devuelve false si choca con otro código (cabecera corrupta)
+bool insertarCodigo(std::vector<NodoDecodificacion>& arbol, uint64_t codigo, int longitud, unsigned char simbolo) {
+    int nodo = 0;
+    for (int i = longitud - 1; i >= 0; i--) {
+        if (arbol[nodo].simbolo >= 0) return false;
+        int b = (codigo >> i) & 1;
+        if (arbol[nodo].hijo[b] < 0) {
+            arbol[nodo].hijo[b] = static_cast<int>(arbol.size());
+            arbol.push_back({{-1, -1}, -1});
+        }
+        nodo = arbol[nodo].hijo[b];
+    }
+    if (arbol[nodo].simbolo >= 0 || arbol[nodo].hijo[0] >= 0 || arbol[nodo].hijo[1] >= 0) return false;
+    arbol[nodo].simbolo = simbolo;
+    return true;
+}
+
+// Reconstruye los códigos canónicos a partir de las longitudes empaquetadas de a dos por byte
+bool construirArbolCanonico(const char empaquetadas[TAM_TABLA_LONGITUDES], std::vector<NodoDecodificacion>& arbol) {
+    int longitudes[256];
+    for (int i = 0; i < TAM_TABLA_LONGITUDES; i++) {
+        longitudes[2 * i] = static_cast<unsigned char>(empaquetadas[i]) >> 4;
+        longitudes[2 * i + 1] = empaquetadas[i] & 0x0F;
+    }
+
+    uint64_t codigos[256];
+    asignarCodigosCanonicos(longitudes, codigos);
+    for (int c = 0; c < 256; c++) {
+        if (longitudes[c] > 0 && !insertarCodigo(arbol, codigos[c], longitudes[c], static_cast<unsigned char>(c)))
+            return false;
+    }
+    return true;
+}
+
+// Cabecera v2: tabla de longitudes de los códigos canónicos. Las tablas se leen del archivo
+// en memoria y avanzan 'cursor' hasta el final de la cabecera.
+bool leerTablaCanonica(const char*& cursor, const char* fin, std::vector<NodoDecodificacion>& arbol) {
+    if (fin - cursor < TAM_TABLA_LONGITUDES) return false;
+    cursor += TAM_TABLA_LONGITUDES;
+    return construirArbolCanonico(cursor - TAM_TABLA_LONGITUDES, arbol);
+}
+
+// Cabecera v1: cantidad de caracteres y, por cada uno, su código escrito como texto
+bool leerTablaTexto(const char*& cursor, const char* fin, std::vector<NodoDecodificacion>& arbol) {
+    if (fin - cursor < static_cast<std::ptrdiff_t>(sizeof(int))) return false;
+    int numCaracteresDistintos = leerEntero<int>(cursor);
+    cursor += sizeof(int);
+    for (int i = 0; i < numCaracteresDistintos; i++) {
+        if (fin - cursor < 2) return false;
+        unsigned char caracter = static_cast<unsigned char>(cursor[0]);
+        u_int8_t longitud = static_cast<u_int8_t>(cursor[1]);
+        cursor += 2;
+        if (fin - cursor < longitud || longitud > 64) return false;
+
+        uint64_t bits = 0;
+        for (int b = 0; b < longitud; b++) bits = (bits << 1) | (cursor[b] == '1');
+        cursor += longitud;
+        if (!insertarCodigo(arbol, bits, longitud, caracter)) return false;
+    }
+    return true;
+}
+
+// Recorre el árbol con cada patrón de BITS_TABLA bits para llenar la tabla principal
+std::vector<EntradaTabla> construirTabla(const std::vector<NodoDecodificacion>& arbol) {
+    std::vector<EntradaTabla> tabla(size_t(1) << BITS_TABLA);
+    for (unsigned patron = 0; patron < tabla.size(); patron++) {
+        EntradaTabla entrada = {0, 0, false};
+        int nodo = 0;
+        for (int profundidad = 1; profundidad <= BITS_TABLA; profundidad++) {
+            nodo = arbol[nodo].hijo[(patron >> (BITS_TABLA - profundidad)) & 1];
+            if (nodo < 0) break;
+            if (arbol[nodo].simbolo >= 0) {
+                entrada = {arbol[nodo].simbolo, static_cast<uint8_t>(profundidad), true};
+                break;
+            }
+            if (profundidad == BITS_TABLA) entrada = {nodo, static_cast<uint8_t>(BITS_TABLA), false};
+        }
+        tabla[patron] = entrada;
+    }
+    return tabla;
+}
+
+// Salida de un bloque: escribe en un buffer del tamaño original del bloque
+class SalidaMemoria {
+public:
+    SalidaMemoria(unsigned char* destino, size_t capacidad) : destino(destino), capacidad(capacidad), usados(0) {}
+
+    void put(unsigned char byte) {
+        if (usados < capacidad) destino[usados] = byte;
+        usados++;
+    }
+
+    size_t escritos() const { return usados; }
+
+private:
+    unsigned char* destino;
+    size_t capacidad;
+    size_t usados;
+};
+
+// Decodifica todos los bits del lector; devuelve false si los datos no corresponden a la tabla
+template <typename Salida>
+bool decodificar(const std::vector<NodoDecodificacion>& arbol, const std::vector<EntradaTabla>& tabla,
+                 LectorBits& lector, Salida& salida) {
+    // Un archivo v1 con un solo caracter tiene un código vacío: no hay bits que decodificar
+    if (arbol[0].simbolo >= 0) return true;
+
+    while (lector.bitsRestantes() > 0) {
+        lector.rellenar();
+
+        // Camino rápido: los códigos que resuelve la tabla se consumen sin volver a rellenar
+        // mientras el acumulador tenga una consulta completa
+        while (lector.enAcumulador() >= BITS_TABLA && lector.bitsRestantes() >= uint64_t(BITS_TABLA)) {
+            const EntradaTabla& entrada = tabla[lector.mirar(BITS_TABLA)];
+            if (!entrada.esHoja) break;
+            lector.consumir(entrada.longitud);
+            salida.put(static_cast<unsigned char>(entrada.valor));
+        }
+        if (lector.bitsRestantes() == 0) break;
+        lector.rellenar();
+
+        const EntradaTabla& entrada = tabla[lector.mirar(BITS_TABLA)];
+        if (entrada.longitud == 0) return false;
+        // Bits sobrantes al final que no completan un código: se ignoran como antes
+        if (entrada.longitud > lector.bitsRestantes()) break;
+        lector.consumir(entrada.longitud);
+        if (entrada.esHoja) {
+            salida.put(static_cast<unsigned char>(entrada.valor));
+            continue;
+        }
+
+        // Código más largo que la tabla: seguir el árbol bit a bit desde donde quedó
+        int nodo = entrada.valor;
+        while (nodo >= 0 && arbol[nodo].simbolo < 0 && lector.bitsRestantes() > 0) {
+            if (lector.enAcumulador() == 0) lector.rellenar();
+            nodo = arbol[nodo].hijo[lector.mirar(1)];
+            lector.consumir(1);
+        }
+        if (nodo < 0) return false;
+        if (arbol[nodo].simbolo < 0) break;  // Código incompleto al final de los datos
+        salida.put(static_cast<unsigned char>(arbol[nodo].simbolo));
+    }
+    return true;
+}
+
+// Descomprime un bloque v3 (cabecera incluida) en 'destino', que tiene lugar para el bloque original
+bool descomprimirBloque(const char* bloque, unsigned char* destino) {
+    uint32_t bytesOriginales = leerEntero<uint32_t>(bloque);
+    uint32_t bytesDatos = leerEntero<uint32_t>(bloque + 4);
+    unsigned char relleno = static_cast<unsigned char>(bloque[TAM_CABECERA_BLOQUE - 1]);
+    if (uint64_t(bytesDatos) * 8 < relleno) return false;
+
+    std::vector<NodoDecodificacion> arbol(1, NodoDecodificacion{{-1, -1}, -1});
+    if (!construirArbolCanonico(bloque + 8, arbol)) return false;
+    std::vector<EntradaTabla> tabla = construirTabla(arbol);
+
+    LectorBits lector(bloque + TAM_CABECERA_BLOQUE, bytesDatos, uint64_t(bytesDatos) * 8 - relleno);
+    SalidaMemoria salida(destino, bytesOriginales);
+    return decodificar(arbol, tabla, lector, salida) && salida.escritos() == bytesOriginales;
+}
+
+// Salida de las versiones 1 y 2: junta los bytes en un buffer fijo y los pasa a la salida pendiente
+class SalidaCola {
+public:
+    explicit SalidaCola(OutputQueue& cola) : cola(cola), usados(0) {}
+    ~SalidaCola() { vaciar(); }
+
+    void put(unsigned char byte) {
+        buffer[usados++] = byte;
+        if (usados == sizeof(buffer)) vaciar();
+    }
+
+    void vaciar() {
+        cola.append(buffer, usados);
+        usados = 0;
+    }
+
+private:
+    OutputQueue& cola;
+    unsigned char buffer[1 << 16];
+    size_t usados;
+};
+
+
+// Comprime por tandas de bloques: cada tanda se comprime en paralelo y se agrega en orden a la
+// salida. Solo se guarda el índice, así que la memoria no depende del tamaño de la entrada.
+class CodificadorHuffman : public StreamBase<Encoder> {
+public:
+    CodificadorHuffman(const Allocator& asignador, size_t tamBloque, unsigned hilos)
+        : StreamBase<Encoder>(asignador), pool(hilos), tamBloque(tamBloque),
+          bloquesPorTanda(2 * pool.numeroHilos()), tamTanda(bloquesPorTanda * tamBloque),
+          bloques(bloquesPorTanda, BloqueComprimido(&allocator), stl<BloqueComprimido>()),
+          correctos(bloquesPorTanda, 0, stl<char>()), pendientes(stl<unsigned char>()), usados(0),
+          indice(stl<uint64_t>()), desplazamiento(sizeof(MAGIA) + 1 + 4) {
+        unsigned char version = VERSION_BLOQUES;
+        uint32_t tamano = static_cast<uint32_t>(tamBloque);
+        output.append(MAGIA, sizeof(MAGIA));
+        output.append(&version, 1);
+        output.append(&tamano, 4);
+    }
+
+protected:
+    size_t consume(const unsigned char* datos, size_t tamano) override {
+        size_t consumidos = 0;
+        while (consumidos < tamano && output.pending() < OUTPUT_LIMIT) {
+            // Sin nada juntado, las tandas completas se comprimen directo desde los datos recibidos
+            // (con un archivo mapeado, desde sus páginas)
+            if (usados == 0 && tamano - consumidos >= tamTanda) {
+                comprimirTanda(datos + consumidos, tamTanda);
+                consumidos += tamTanda;
+                continue;
+            }
+            if (pendientes.empty()) pendientes.resize(tamTanda);
+            size_t n = std::min(tamTanda - usados, tamano - consumidos);
+            memcpy(pendientes.data() + usados, datos + consumidos, n);
+            usados += n;
+            consumidos += n;
+            if (usados == tamTanda) {
+                comprimirTanda(pendientes.data(), usados);
+                usados = 0;
+            }
+        }
+        return consumidos;
+    }
+
+    // Última tanda, marca de fin, índice de bloques y cantidad
+    void finish() override {
+        if (usados > 0) comprimirTanda(pendientes.data(), usados);
+        usados = 0;
+        uint32_t fin = 0;
+        uint64_t cantidad = indice.size();
+        output.append(&fin, 4);
+        output.append(indice.data(), 8 * indice.size());
+        output.append(&cantidad, 8);
+    }
+
+    size_t objectSize() const override { return sizeof(*this); }
+
+private:
+    PoolHilos pool;
+    size_t tamBloque;
+    size_t bloquesPorTanda;  // Dos por hilo para que ningún hilo quede esperando al más lento
+    size_t tamTanda;
+    Vector<BloqueComprimido> bloques;
+    Vector<char> correctos;             // false si a un hilo le faltó memoria
+    Vector<unsigned char> pendientes;   // Tanda que se va juntando de entregas más chicas
+    size_t usados;
+    Vector<uint64_t> indice;
+    uint64_t desplazamiento;
+
+    void comprimirTanda(const unsigned char* datos, size_t leidos) {
+        int cantidad = static_cast<int>((leidos + tamBloque - 1) / tamBloque);
+        pool.paraCada(cantidad, [&](int i) {
+            size_t inicio = i * tamBloque;
+            size_t tamano = std::min(tamBloque, leidos - inicio);
+            try {
+                comprimirBloque(datos + inicio, tamano, bloques[i]);
+                correctos[i] = true;
+            } catch (const std::bad_alloc&) {
+                correctos[i] = false;
+            }
+        });
+
+        for (int i = 0; i < cantidad; i++) {
+            if (!correctos[i]) throw std::bad_alloc();
+            indice.push_back(desplazamiento);
+            output.append(bloques[i].cabecera, TAM_CABECERA_BLOQUE);
+            output.append(bloques[i].datos.data(), bloques[i].datos.size());
+            desplazamiento += TAM_CABECERA_BLOQUE + bloques[i].datos.size();
+        }
+    }
+};
+
+
+// Descomprime a medida que llegan los datos. En la versión 3 los bloques se recorren en orden
+// con los tamaños de sus cabeceras y se descomprimen por tandas en paralelo, directo en la salida
+// pendiente. Los bloques que llegan enteros en un push() se decodifican en su lugar, sin copiarlos;
+// solo se copian los que llegan partidos o los que quedan en una tanda incompleta al volver.
+// Las versiones 1 y 2 no tienen bloques: se juntan completas y se descomprimen en finish().
+class DecodificadorHuffman : public StreamBase<Decoder> {
+public:
+    DecodificadorHuffman(const Allocator& asignador, unsigned hilos)
+        : StreamBase<Decoder>(asignador), pool(hilos), bloquesPorTanda(2 * pool.numeroHilos()),
+          estado(LEYENDO_FIRMA), usadosCabecera(0), version(0), tamBloque(0), legado(stl<char>()),
+          tanda(stl<BloquePendiente>()), copias(stl<char>()), parcial(stl<char>()),
+          destinos(bloquesPorTanda, 0, stl<size_t>()), correctos(bloquesPorTanda, 0, stl<char>()),
+          cantidad(0), pie(stl<char>()) {
+        tanda.reserve(bloquesPorTanda);
+    }
+
+protected:
+    size_t consume(const unsigned char* entrada, size_t tamano) override {
+        const char* datos = reinterpret_cast<const char*>(entrada);
+        size_t i = 0;
+        while (i < tamano && !failed()) {
+            switch (estado) {
+            case LEYENDO_FIRMA:
+                i += juntarCabecera(datos + i, tamano - i, sizeof(MAGIA) + 1);
+                if (usadosCabecera == sizeof(MAGIA) + 1) identificarVersion();
+                break;
+            case LEYENDO_TAM_BLOQUE:
+                i += juntarCabecera(datos + i, tamano - i, 4);
+                if (usadosCabecera == 4) {
+                    tamBloque = leerEntero<uint32_t>(cabecera);
+                    estado = BLOQUES;
+                }
+                break;
+            case BLOQUES:
+                i = leerBloques(datos, i, tamano);
+                if (estado == BLOQUES) return failed() ? tamano : i;
+                break;
+            case PIE:
+                // El índice no hace falta, pero su tamaño confirma que el archivo llegó completo
+                if (pie.size() + (tamano - i) > 8 * cantidad + 8) {
+                    fail("Hay datos de más al final del archivo comprimido");
+                    break;
+                }
+                pie.insert(pie.end(), datos + i, datos + tamano);
+                i = tamano;
+                break;
+            case LEGADO:
+                legado.insert(legado.end(), datos + i, datos + tamano);
+                i = tamano;
+                break;
+            }
+        }
+        return failed() ? tamano : i;
+    }
+
+    void finish() override {
+        switch (estado) {
+        case LEYENDO_FIRMA:
+            // Menos de 4 bytes: solo puede ser un archivo v1 (que igual va a resultar inválido)
+            version = 1;
+            legado.assign(cabecera, cabecera + usadosCabecera);
+            descomprimirLegado();
+            break;
+        case LEYENDO_TAM_BLOQUE:
+        case BLOQUES:
+            fail("El archivo comprimido está truncado");
+            break;
+        case PIE:
+            if (pie.size() != 8 * cantidad + 8 || leerEntero<uint64_t>(pie.data() + 8 * cantidad) != cantidad)
+                fail("El archivo comprimido está truncado");
+            break;
+        case LEGADO:
+            descomprimirLegado();
+            break;
+        }
+    }
+
+    size_t objectSize() const override { return sizeof(*this); }
+
+private:
+    enum Estado { LEYENDO_FIRMA, LEYENDO_TAM_BLOQUE, BLOQUES, PIE, LEGADO };
+
+    // Bloque de la tanda: apunta a los datos del push() en curso o a su copia en 'copias'
+    struct BloquePendiente {
+        const char* externo;
+        size_t inicio;
+    };
+
+    PoolHilos pool;
+    size_t bloquesPorTanda;
+    Estado estado;
+    char cabecera[sizeof(MAGIA) + 1];
+    size_t usadosCabecera;
+    unsigned char version;
+    uint64_t tamBloque;
+    Vector<char> legado;                // Archivo v1 o v2 completo
+    Vector<BloquePendiente> tanda;
+    Vector<char> copias;
+    Vector<char> parcial;               // Bloque que llegó solo en parte
+    Vector<size_t> destinos;            // Posición de cada bloque de la tanda en la salida
+    Vector<char> correctos;
+    uint64_t cantidad;                  // Bloques ya descomprimidos
+    Vector<char> pie;
+
+    size_t juntarCabecera(const char* datos, size_t tamano, size_t total) {
+        size_t n = std::min(tamano, total - usadosCabecera);
+        memcpy(cabecera + usadosCabecera, datos, n);
+        usadosCabecera += n;
+        return n;
+    }
+
+    // Identificar la versión del archivo por la firma
+    void identificarVersion() {
+        bool tieneFirma = memcmp(cabecera, MAGIA, sizeof(MAGIA)) == 0;
+        version = tieneFirma ? static_cast<unsigned char>(cabecera[sizeof(MAGIA)]) : 1;
+        if (version == VERSION_BLOQUES) {
+            usadosCabecera = 0;
+            estado = LEYENDO_TAM_BLOQUE;
+        } else if (version == 1 || version == VERSION_FORMATO) {
+            legado.assign(cabecera, cabecera + usadosCabecera);
+            estado = LEGADO;
+        } else {
+            fail("Versión de archivo no soportada");
+        }
+    }
+
+    // Ningún código supera LONGITUD_MAXIMA bits: acota lo que se junta de un archivo corrupto
+    bool cabeceraValida(uint32_t bytesOriginales, uint32_t bytesDatos) {
+        if (bytesOriginales > tamBloque || uint64_t(bytesDatos) * 8 > uint64_t(bytesOriginales) * LONGITUD_MAXIMA + 7) {
+            fail("Los datos comprimidos no corresponden a la tabla de códigos");
+            return false;
+        }
+        return true;
+    }
+
+    // Recorre los bloques de datos[i, tamano) y devuelve hasta dónde llegó: antes del final solo
+    // si la salida pendiente está llena, y entonces con la tanda vacía
+    size_t leerBloques(const char* datos, size_t i, size_t tamano) {
+        for (;;) {
+            if (tanda.size() == bloquesPorTanda) descomprimirTanda();
+            if (failed()) return tamano;
+            if (i == tamano || (tanda.empty() && output.pending() >= OUTPUT_LIMIT)) break;
+
+            // Bloque entero en los datos recibidos: se usa en su lugar
+            if (parcial.empty() && tamano - i >= size_t(TAM_CABECERA_BLOQUE)) {
+                const char* bloque = datos + i;
+                uint32_t bytesOriginales = leerEntero<uint32_t>(bloque);
+                if (bytesOriginales == 0) {
+                    terminarBloques();
+                    return i + 4;
+                }
+                uint32_t bytesDatos = leerEntero<uint32_t>(bloque + 4);
+                if (!cabeceraValida(bytesOriginales, bytesDatos)) return tamano;
+                size_t total = TAM_CABECERA_BLOQUE + size_t(bytesDatos);
+                if (tamano - i >= total) {
+                    tanda.push_back(BloquePendiente{bloque, 0});
+                    i += total;
+                    continue;
+                }
+            }
+
+            // Bloque partido entre dos push(): se junta en 'parcial' hasta completarlo
+            size_t necesarios = parcial.size() < 4 ? 4
+                              : parcial.size() < size_t(TAM_CABECERA_BLOQUE)
+                                  ? TAM_CABECERA_BLOQUE
+                                  : TAM_CABECERA_BLOQUE + size_t(leerEntero<uint32_t>(parcial.data() + 4));
+            size_t n = std::min(necesarios - parcial.size(), tamano - i);
+            parcial.insert(parcial.end(), datos + i, datos + i + n);
+            i += n;
+            if (parcial.size() == 4 && leerEntero<uint32_t>(parcial.data()) == 0) {
+                parcial.clear();
+                terminarBloques();
+                return i;
+            }
+            if (parcial.size() == size_t(TAM_CABECERA_BLOQUE) &&
+                !cabeceraValida(leerEntero<uint32_t>(parcial.data()), leerEntero<uint32_t>(parcial.data() + 4)))
+                return tamano;
+            if (parcial.size() >= size_t(TAM_CABECERA_BLOQUE) &&
+                parcial.size() == TAM_CABECERA_BLOQUE + size_t(leerEntero<uint32_t>(parcial.data() + 4))) {
+                tanda.push_back(BloquePendiente{nullptr, copias.size()});
+                copias.insert(copias.end(), parcial.begin(), parcial.end());
+                parcial.clear();
+            }
+        }
+
+        // Los datos del push() dejan de ser válidos al volver: se copian los bloques que apuntan a ellos
+        for (size_t b = 0; b < tanda.size(); b++) {
+            if (!tanda[b].externo) continue;
+            size_t total = TAM_CABECERA_BLOQUE + size_t(leerEntero<uint32_t>(tanda[b].externo + 4));
+            tanda[b].inicio = copias.size();
+            copias.insert(copias.end(), tanda[b].externo, tanda[b].externo + total);
+            tanda[b].externo = nullptr;
+        }
+        return i;
+    }
+
+    // Llegó la marca de fin: se descomprime lo que queda de la tanda y sigue el índice
+    void terminarBloques() {
+        descomprimirTanda();
+        estado = PIE;
+    }
+
+    const char* bloque(size_t i) const {
+        return tanda[i].externo ? tanda[i].externo : copias.data() + tanda[i].inicio;
+    }
+
+    void descomprimirTanda() {
+        int total = static_cast<int>(tanda.size());
+        if (total == 0) return;
+
+        size_t bytes = 0;
+        for (int i = 0; i < total; i++) {
+            destinos[i] = bytes;
+            bytes += leerEntero<uint32_t>(bloque(i));
+        }
+        unsigned char* destino = output.reserve(bytes);
+        pool.paraCada(total, [&](int i) {
+            try {
+                correctos[i] = descomprimirBloque(bloque(i), destino + destinos[i]);
+            } catch (const std::bad_alloc&) {
+                correctos[i] = false;
+            }
+        });
+        for (int i = 0; i < total; i++) {
+            if (!correctos[i]) {
+                fail("Los datos comprimidos no corresponden a la tabla de códigos");
+                return;
+            }
+        }
+        output.commit(bytes);
+        cantidad += total;
+        tanda.clear();
+        copias.clear();
+    }
+
+    // Versiones 1 y 2: un único flujo de bits con una sola tabla
+    void descomprimirLegado() {
+        const char* inicio = legado.data();
+        const char* fin = inicio + legado.size();
+        const char* cursor = version == 1 ? inicio : inicio + sizeof(MAGIA) + 1;
+        std::vector<NodoDecodificacion> arbol(1, NodoDecodificacion{{-1, -1}, -1});
+        bool tablaValida = version == VERSION_FORMATO ? leerTablaCanonica(cursor, fin, arbol)
+                                                      : leerTablaTexto(cursor, fin, arbol);
+        if (!tablaValida) {
+            fail("La tabla de códigos del archivo comprimido es inválida");
+            return;
+        }
+
+        // Leer el padding y calcular cuántos bits de datos hay
+        if (cursor == fin) {
+            fail("El archivo comprimido está truncado");
+            return;
+        }
+        u_int8_t padding = static_cast<u_int8_t>(*cursor++);
+        uint64_t bytesDatos = static_cast<uint64_t>(fin - cursor);
+        if (bytesDatos * 8 < padding) {
+            fail("El archivo comprimido está truncado");
+            return;
+        }
+
+        std::vector<EntradaTabla> tabla = construirTabla(arbol);
+        LectorBits lector(cursor, bytesDatos, bytesDatos * 8 - padding);
+        SalidaCola salida(output);
+        if (!decodificar(arbol, tabla, lector, salida))
+            fail("Los datos comprimidos no corresponden a la tabla de códigos");
+    }
+};
+
+
+Encoder* newHuffmanEncoder(size_t blockSize, unsigned threads, const Allocator* allocator) {
+    if (blockSize < HUFFMAN_MIN_BLOCK_SIZE || blockSize > HUFFMAN_MAX_BLOCK_SIZE) return nullptr;
+    return create<CodificadorHuffman>(allocator, blockSize, threads);
+}
+
+Decoder* newHuffmanDecoder(unsigned threads, const Allocator* allocator) {
+    return create<DecodificadorHuffman>(allocator, threads);
+}
+
+}  // namespace codec
@@ -0,0 +1,189 @@
+#ifndef CODEC_INTERNO_H
+#define CODEC_INTERNO_H
+
+// Piezas compartidas por las implementaciones de los códecs; no es parte de la interfaz pública
+
+#include "codec.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace codec {
+
+// malloc y free, para cuando no se indica un asignador
+const Allocator& defaultAllocator();
+
+// Adaptador para que los contenedores de la STL pidan memoria al asignador del códec
+template <typename T>
+struct StlAllocator {
+    typedef T value_type;
+
+    const Allocator* allocator;
+
+    explicit StlAllocator(const Allocator* allocator) : allocator(allocator) {}
+    template <typename U>
+    StlAllocator(const StlAllocator<U>& other) : allocator(other.allocator) {}
+
+    T* allocate(size_t n) {
+        void* pointer = allocator->allocate(n * sizeof(T), allocator->context);
+        if (!pointer) throw std::bad_alloc();
+        return static_cast<T*>(pointer);
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        allocator->release(pointer, n * sizeof(T), allocator->context);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const StlAllocator<T>& a, const StlAllocator<U>& b) { return a.allocator == b.allocator; }
+template <typename T, typename U>
+bool operator!=(const StlAllocator<T>& a, const StlAllocator<U>& b) { return a.allocator != b.allocator; }
+
+template <typename T>
+using Vector = std::vector<T, StlAllocator<T> >;
+
+// push() deja de consumir entrada cuando la salida pendiente llega a este tamaño
+static const size_t OUTPUT_LIMIT = 1 << 18;
+
+// Salida pendiente de un códec: se agrega al final y pull() retira del principio. Cuando se
+// vacía vuelve al comienzo del buffer, así no crece mientras la salida se vaya retirando.
+class OutputQueue {
+public:
+    explicit OutputQueue(const Allocator* allocator)
+        : buffer(StlAllocator<unsigned char>(allocator)), start(0), end(0) {}
+
+    size_t pending() const { return end - start; }
+
+    // Lugar para 'size' bytes más al final; lo escrito se confirma con commit()
+    unsigned char* reserve(size_t size) {
+        if (buffer.size() - end < size && start > 0) {
+            memmove(buffer.data(), buffer.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        if (buffer.size() - end < size) buffer.resize(std::max(end + size, 2 * buffer.size()));
+        return buffer.data() + end;
+    }
+
+    void commit(size_t size) { end += size; }
+
+    void append(const void* data, size_t size) {
+        if (size == 0) return;
+        memcpy(reserve(size), data, size);
+        end += size;
+    }
+
+    size_t pull(unsigned char* out, size_t capacity) {
+        size_t n = std::min(capacity, end - start);
+        if (n == 0) return 0;
+        memcpy(out, buffer.data() + start, n);
+        start += n;
+        if (start == end) start = end = 0;
+        return n;
+    }
+
+private:
+    Vector<unsigned char> buffer;
+    size_t start;
+    size_t end;
+};
+
+// Base de las implementaciones: la salida pendiente, el primer error y el ciclo de vida.
+// Cada códec implementa consume() y finish(); una memoria agotada en ellos termina en error().
+template <typename Interface>
+class StreamBase : public Interface {
+public:
+    size_t push(const unsigned char* data, size_t size) override {
+        if (message[0] != '\0') return size;
+        if (finished) {
+            fail("push() después de flush()");
+            return size;
+        }
+        try {
+            return consume(data, size);
+        } catch (const std::bad_alloc&) {
+            fail("No hay memoria suficiente");
+            return size;
+        }
+    }
+
+    size_t pull(unsigned char* out, size_t capacity) override { return output.pull(out, capacity); }
+
+    bool flush() override {
+        if (!finished && message[0] == '\0') {
+            finished = true;
+            try {
+                finish();
+            } catch (const std::bad_alloc&) {
+                fail("No hay memoria suficiente");
+            }
+        }
+        finished = true;
+        return message[0] == '\0';
+    }
+
+    size_t pending() const override { return output.pending(); }
+
+    const char* error() const override { return message[0] != '\0' ? message : nullptr; }
+
+protected:
+    Allocator allocator;  // Copia propia: los contenedores del códec apuntan a ella
+    OutputQueue output;
+
+    explicit StreamBase(const Allocator& allocator)
+        : allocator(allocator), output(&this->allocator), finished(false) {
+        message[0] = '\0';
+    }
+
+    template <typename T>
+    StlAllocator<T> stl() { return StlAllocator<T>(&allocator); }
+
+    // Guarda el primer error, con el formato de printf
+    void fail(const char* format, ...) {
+        if (message[0] != '\0') return;
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(message, sizeof(message), format, arguments);
+        va_end(arguments);
+    }
+
+    bool failed() const { return message[0] != '\0'; }
+
+    virtual size_t consume(const unsigned char* data, size_t size) = 0;
+    virtual void finish() = 0;
+    virtual size_t objectSize() const = 0;
+
+    void release() override {
+        Allocator owner = allocator;
+        size_t size = objectSize();
+        this->~StreamBase();
+        owner.release(this, size, owner.context);
+    }
+
+private:
+    bool finished;
+    char message[160];
+};
+
+// Crea un códec con la memoria del asignador; nullptr si no alcanza
+template <typename T, typename... Args>
+T* create(const Allocator* allocator, Args&&... args) {
+    const Allocator& owner = allocator ? *allocator : defaultAllocator();
+    void* memory = owner.allocate(sizeof(T), owner.context);
+    if (!memory) return nullptr;
+    try {
+        return new (memory) T(owner, std::forward<Args>(args)...);
+    } catch (const std::bad_alloc&) {
+        owner.release(memory, sizeof(T), owner.context);
+        return nullptr;
+    }
+}
+
+}  // namespace codec
+
+#endif
@@ -0,0 +1,383 @@
+#include "interno.h"
+#include <map>
+#include <string>
+
+namespace codec {
+
+// Formato v2: cabecera "LZW" + versión + ancho máximo, seguida de códigos de ancho variable
+// empaquetados en bits (LSB primero). El ancho empieza en 9 bits y crece al llenarse el diccionario.
+static const char MAGIC[3] = {'L', 'Z', 'W'};
+static const unsigned char FORMAT_VERSION = 2;
+static const int HEADER_SIZE = 5;
+
+static const int CLEAR_CODE = 256;  // Reinicia el diccionario y vuelve a 9 bits
+static const int END_CODE = 257;    // Fin de los datos
+static const int FIRST_CODE = 258;  // Primer código libre del diccionario
+
+static const size_t IO_BUFFER_SIZE = 1 << 16;  // Buffer fijo de salida y tramos de entrada
+
+
+// Escribe códigos de ancho variable en un acumulador de 64 bits y vacía bytes completos
+// a un buffer fijo, que se pasa a la salida pendiente cuando se llena o con sync().
+class BitWriter {
+public:
+    BitWriter(OutputQueue& out, const Allocator* allocator)
+        : out(out), buffer(IO_BUFFER_SIZE, 0, StlAllocator<unsigned char>(allocator)), used(0), bits(0), count(0) {}
+
+    void write(int code, int width) {
+        bits |= uint64_t(code) << count;
+        count += width;
+        while (count >= 8) {
+            buffer[used++] = static_cast<unsigned char>(bits & 0xFF);
+            bits >>= 8;
+            count -= 8;
+            if (used == buffer.size()) sync();
+        }
+    }
+
+    // Completa el último byte con ceros y pasa lo pendiente a la salida
+    void finish() {
+        if (count > 0) {
+            buffer[used++] = static_cast<unsigned char>(bits & 0xFF);
+            bits = 0;
+            count = 0;
+        }
+        sync();
+    }
+
+    // Pasa los bytes completos a la salida; los bits sueltos quedan en el acumulador
+    void sync() {
+        out.append(buffer.data(), used);
+        used = 0;
+    }
+
+private:
+    OutputQueue& out;
+    Vector<unsigned char> buffer;
+    size_t used;
+    uint64_t bits;
+    int count;
+};
+
+
+// Estado del codificador: el diccionario se reinicia con CLEAR cuando se agotan los códigos
+// del ancho máximo, así la memoria queda acotada sin importar el tamaño de la entrada.
+//
+// Cada entrada del diccionario es (código del prefijo, byte siguiente) y se guarda en una tabla
+// hash de direccionamiento abierto con al menos el doble de casillas que códigos posibles:
+// cada byte de entrada cuesta una búsqueda O(1) sin reservar memoria.
+class LzwEncoder : public StreamBase<Encoder> {
+public:
+    LzwEncoder(const Allocator& allocator, int maxBits)
+        : StreamBase<Encoder>(allocator), writer(output, &this->allocator), maxBits(maxBits),
+          keys(size_t(2) << maxBits, EMPTY_KEY, stl<uint32_t>()), codes(keys.size(), 0, stl<uint16_t>()),
+          mask(keys.size() - 1), prefix(NO_PREFIX) {
+        char header[HEADER_SIZE] = {MAGIC[0], MAGIC[1], MAGIC[2],
+                                    static_cast<char>(FORMAT_VERSION), static_cast<char>(maxBits)};
+        output.append(header, HEADER_SIZE);
+        reset();
+    }
+
+protected:
+    // De a IO_BUFFER_SIZE bytes, hasta que la salida pendiente llegue al límite
+    size_t consume(const unsigned char* data, size_t length) override {
+        size_t used = 0;
+        while (used < length && output.pending() < OUTPUT_LIMIT) {
+            size_t n = std::min(length - used, IO_BUFFER_SIZE);
+            encode(data + used, n);
+            used += n;
+        }
+        writer.sync();
+        return used;
+    }
+
+    void finish() override {
+        if (prefix != NO_PREFIX) {
+            writer.write(prefix, width);
+            advance();  // El decodificador ajusta el ancho como si se hubiera agregado una entrada
+        }
+        writer.write(END_CODE, width);
+        writer.finish();
+    }
+
+    size_t objectSize() const override { return sizeof(*this); }
+
+private:
+    static const int NO_PREFIX = -1;
+    static const uint32_t EMPTY_KEY = 0xFFFFFFFF;  // Ninguna clave real usa los 8 bits altos
+
+    BitWriter writer;
+    int maxBits;
+    Vector<uint32_t> keys;   // (prefijo << 8) | byte
+    Vector<uint16_t> codes;  // Código asignado a cada clave
+    size_t mask;
+    int prefix;              // Código de la secuencia acumulada hasta ahora
+    int nextCode;
+    int width;
+
+    void encode(const unsigned char* data, size_t length) {
+        size_t i = 0;
+        if (prefix == NO_PREFIX && length > 0) prefix = data[i++];
+
+        for (; i < length; i++) {
+            uint32_t key = (uint32_t(prefix) << 8) | data[i];
+            size_t slot = hash(key);
+            while (keys[slot] != key && keys[slot] != EMPTY_KEY) slot = (slot + 1) & mask;
+
+            if (keys[slot] == key) {
+                prefix = codes[slot];
+            } else {
+                writer.write(prefix, width);
+                keys[slot] = key;
+                codes[slot] = static_cast<uint16_t>(nextCode);
+                advance();
+                prefix = data[i];
+            }
+        }
+    }
+
+    size_t hash(uint32_t key) const {
+        return (key * 2654435761u) >> 8 & mask;
+    }
+
+    // Los códigos 0-255 son los bytes sueltos y no necesitan entrada en la tabla
+    void reset() {
+        std::fill(keys.begin(), keys.end(), EMPTY_KEY);
+        nextCode = FIRST_CODE;
+        width = LZW_MIN_BITS;
+    }
+
+    // Cuenta el código recién emitido; al llenarse el ancho actual crece o, en el máximo, reinicia
+    void advance() {
+        nextCode++;
+        if (nextCode == (1 << width)) {
+            if (width < maxBits) {
+                width++;
+            } else {
+                writer.write(CLEAR_CODE, width);
+                reset();
+            }
+        }
+    }
+};
+
+const int LzwEncoder::NO_PREFIX;
+const uint32_t LzwEncoder::EMPTY_KEY;
+
+
+// Formato v1: un int con la cantidad de códigos seguido de cada código como int de 4 bytes
+static bool decompressLegacy(const unsigned char* data, OutputQueue& out) {
+    int resultSize;
+    memcpy(&resultSize, data, sizeof(resultSize));
+
+    std::vector<int> compressed(resultSize);
+    if (resultSize > 0) memcpy(compressed.data(), data + sizeof(int), sizeof(int) * size_t(resultSize));
+
+    std::map<int, std::string> dictionary;
+    for (int i = 0; i < 256; i++) {
+        dictionary[i] = std::string(1, char(i));
+    }
+
+    std::string entry;
+    int nextCode = 256;
+
+    if (compressed.empty()) {
+        return true;
+    }
+
+    std::string result = dictionary[compressed[0]];
+    out.append(result.c_str(), result.length());
+
+    for (size_t i = 1; i < compressed.size(); i++) {
+        int code = compressed[i];
+
+        if (dictionary.count(code)) {
+            entry = dictionary[code];
+        } else if (code == nextCode) {
+            entry = result + result[0];
+        } else {
+            return false;
+        }
+
+        out.append(entry.c_str(), entry.length());
+
+        dictionary[nextCode++] = result + entry[0];
+        result = entry;
+    }
+    return true;
+}
+
+// Un archivo v1 no tiene cabecera: se reconoce porque su tamaño es 4 + 4 * cantidad de códigos
+static bool isLegacyFile(const unsigned char* data, size_t size) {
+    int resultSize;
+    if (size < sizeof(resultSize)) return false;
+    memcpy(&resultSize, data, sizeof(resultSize));
+    return resultSize >= 0 && uint64_t(size) == sizeof(int) * (1 + uint64_t(resultSize));
+}
+
+
+// Descomprime el formato v2 a medida que llegan los bytes: los bits que no completan un código
+// quedan en el acumulador hasta el próximo push().
+// Cada código guarda su prefijo y su último byte; la cadena se reconstruye de atrás hacia
+// adelante en un buffer reutilizable, sin copiar cadenas por cada código.
+class LzwDecoder : public StreamBase<Decoder> {
+public:
+    explicit LzwDecoder(const Allocator& allocator)
+        : StreamBase<Decoder>(allocator), headerUsed(0), legacy(false), ended(false),
+          legacyData(stl<unsigned char>()), prefixes(stl<uint16_t>()), suffixes(stl<unsigned char>()),
+          stack(stl<unsigned char>()), maxBits(0), tableSize(0), previous(-1), previousFirst(0),
+          nextCode(FIRST_CODE), width(LZW_MIN_BITS), bits(0), count(0) {}
+
+protected:
+    size_t consume(const unsigned char* data, size_t size) override {
+        size_t i = 0;
+        if (headerUsed < HEADER_SIZE) {
+            size_t n = std::min(size, size_t(HEADER_SIZE - headerUsed));
+            memcpy(header + headerUsed, data, n);
+            headerUsed += static_cast<int>(n);
+            i = n;
+            if (headerUsed < HEADER_SIZE || !readHeader()) return size;
+        }
+
+        // El formato v1 no tiene cabecera: se junta todo para reconocerlo en finish()
+        if (legacy) {
+            legacyData.insert(legacyData.end(), data + i, data + size);
+            return size;
+        }
+        if (ended) return size;  // Lo que sigue a END_CODE no es parte de los datos
+
+        for (; i < size && output.pending() < OUTPUT_LIMIT; i++) {
+            bits |= uint64_t(data[i]) << count;
+            count += 8;
+            while (count >= width) {
+                int code = static_cast<int>(bits & ((uint64_t(1) << width) - 1));
+                bits >>= width;
+                count -= width;
+                if (!decode(code)) return size;
+                if (ended) return size;
+            }
+        }
+        return i;
+    }
+
+    void finish() override {
+        if (headerUsed < HEADER_SIZE) {
+            legacy = true;
+            legacyData.assign(header, header + headerUsed);
+        }
+        if (legacy) {
+            if (!isLegacyFile(legacyData.data(), legacyData.size())) {
+                fail("El archivo no tiene un formato LZW reconocido");
+            } else if (!decompressLegacy(legacyData.data(), output)) {
+                fail("Código inválido encontrado durante la descompresión");
+            }
+            return;
+        }
+        if (!ended) fail("El archivo comprimido está truncado");
+    }
+
+    size_t objectSize() const override { return sizeof(*this); }
+
+private:
+    unsigned char header[HEADER_SIZE];
+    int headerUsed;
+    bool legacy;
+    bool ended;                        // Ya llegó END_CODE
+    Vector<unsigned char> legacyData;  // Solo en el formato v1
+
+    Vector<uint16_t> prefixes;
+    Vector<unsigned char> suffixes;
+    Vector<unsigned char> stack;  // Ninguna cadena supera la cantidad de códigos
+    int maxBits;
+    int tableSize;
+    int previous;                 // Código anterior; -1 justo después de un CLEAR
+    unsigned char previousFirst;
+    int nextCode;
+    int width;
+    uint64_t bits;
+    int count;
+
+    // Valida la cabecera v2 y prepara las tablas; sin la firma es un archivo v1
+    bool readHeader() {
+        if (memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+            legacy = true;
+            legacyData.assign(header, header + HEADER_SIZE);
+            return true;
+        }
+        if (header[3] != FORMAT_VERSION) {
+            fail("Versión de formato no soportada: %d", int(header[3]));
+            return false;
+        }
+        maxBits = header[4];
+        if (maxBits < LZW_MIN_MAX_BITS || maxBits > LZW_MAX_MAX_BITS) {
+            fail("Ancho máximo de código inválido en la cabecera: %d", maxBits);
+            return false;
+        }
+
+        tableSize = 1 << maxBits;
+        prefixes.resize(tableSize);
+        suffixes.resize(tableSize);
+        stack.resize(tableSize);
+        for (int i = 0; i < 256; i++) {
+            suffixes[i] = static_cast<unsigned char>(i);
+        }
+        return true;
+    }
+
+    bool decode(int code) {
+        if (code == END_CODE) {
+            ended = true;
+            return true;
+        }
+
+        if (code == CLEAR_CODE) {
+            previous = -1;
+            nextCode = FIRST_CODE;
+            width = LZW_MIN_BITS;
+            return true;
+        }
+
+        // Caso especial: el código aún no existe porque es la cadena anterior más su primer byte
+        size_t start = stack.size();
+        int current = code;
+        if (code == nextCode && previous >= 0) {
+            stack[--start] = previousFirst;
+            current = previous;
+        } else if (code >= nextCode || (code >= 256 && code < FIRST_CODE)) {
+            fail("Código inválido encontrado durante la descompresión");
+            return false;
+        }
+
+        while (current >= FIRST_CODE) {
+            stack[--start] = suffixes[current];
+            current = prefixes[current];
+        }
+        stack[--start] = static_cast<unsigned char>(current);
+
+        output.append(stack.data() + start, stack.size() - start);
+
+        if (previous >= 0 && nextCode < tableSize) {
+            prefixes[nextCode] = static_cast<uint16_t>(previous);
+            suffixes[nextCode] = stack[start];
+            nextCode++;
+        }
+        previous = code;
+        previousFirst = stack[start];
+
+        // Mismo criterio que el codificador, que va una entrada por delante
+        if (nextCode + 1 == (1 << width) && width < maxBits) width++;
+        return true;
+    }
+};
+
+
+Encoder* newLzwEncoder(int maxBits, const Allocator* allocator) {
+    if (maxBits < LZW_MIN_MAX_BITS || maxBits > LZW_MAX_MAX_BITS) return nullptr;
+    return create<LzwEncoder>(allocator, maxBits);
+}
+
+Decoder* newLzwDecoder(const Allocator* allocator) {
+    return create<LzwDecoder>(allocator);
+}
+
+}  // namespace codec
@@ -0,0 +1,102 @@
+#include "anillo.h"
+#include <algorithm>
+
+// Vueltas que un lado espera activamente antes de dormir: cubren la pausa corta entre dos
+// pasadas del otro lado sin pagar una llamada al sistema
+static const int GIROS = 2000;
+
+static inline void pausa() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+Anillo::Anillo(size_t capacidad)
+    : escrito(0), leidoVisto(0), leido(0), escritoVisto(0), cerrado(false), abortado(false),
+      productorEsperando(false), consumidorEsperando(false) {
+    size_t tamano = 1;
+    while (tamano < capacidad) tamano <<= 1;
+    buffer.resize(tamano);
+    mascara = tamano - 1;
+}
+
+// Espera hasta que 'lista' se cumpla o se aborte. Antes de dormir marca 'esperando' y vuelve a
+// mirar: el otro lado publica su índice y después mira la marca, todo con orden secuencial, así
+// que alguno de los dos ve al otro y no se pierde ningún aviso.
+template <typename Condicion>
+void Anillo::esperar(Condicion lista, std::atomic<bool>& esperando) {
+    for (int i = 0; i < GIROS; i++) {
+        if (lista() || abortado.load(std::memory_order_acquire)) return;
+        pausa();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    esperando.store(true);
+    while (!lista() && !abortado.load(std::memory_order_acquire)) cambio.wait(lock);
+    esperando.store(false, std::memory_order_relaxed);
+}
+
+void Anillo::despertar(std::atomic<bool>& esperando) {
+    if (esperando.load()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cambio.notify_all();
+    }
+}
+
+unsigned char* Anillo::espacio(size_t& tamano) {
+    size_t propio = escrito.load(std::memory_order_relaxed);
+    if (propio - leidoVisto > buffer.size() / 2) leidoVisto = leido.load(std::memory_order_acquire);
+    if (propio - leidoVisto == buffer.size()) {
+        esperar([&] {
+            leidoVisto = leido.load();
+            return propio - leidoVisto < buffer.size();
+        }, productorEsperando);
+    }
+    if (abortado.load(std::memory_order_acquire)) {
+        tamano = 0;
+        return nullptr;
+    }
+    size_t inicio = propio & mascara;
+    tamano = std::min(buffer.size() - (propio - leidoVisto), buffer.size() - inicio);
+    return buffer.data() + inicio;
+}
+
+void Anillo::publicar(size_t n) {
+    if (n == 0) return;
+    escrito.store(escrito.load(std::memory_order_relaxed) + n);
+    despertar(consumidorEsperando);
+}
+
+void Anillo::cerrar() {
+    cerrado.store(true);
+    despertar(consumidorEsperando);
+}
+
+bool Anillo::datos(Tramo& tramo) {
+    size_t propio = leido.load(std::memory_order_relaxed);
+    if (escritoVisto - propio < buffer.size() / 2) escritoVisto = escrito.load(std::memory_order_acquire);
+    if (escritoVisto == propio) {
+        esperar([&] {
+            // 'cerrado' antes que el índice: si ya estaba cerrado, el índice leído es el final
+            bool fin = cerrado.load();
+            escritoVisto = escrito.load();
+            return escritoVisto != propio || fin;
+        }, consumidorEsperando);
+    }
+    if (abortado.load(std::memory_order_acquire)) return false;
+    size_t inicio = propio & mascara;
+    tramo.datos = buffer.data() + inicio;
+    tramo.tamano = std::min(escritoVisto - propio, buffer.size() - inicio);
+    return true;
+}
+
+void Anillo::liberar(size_t n) {
+    if (n == 0) return;
+    leido.store(leido.load(std::memory_order_relaxed) + n);
+    despertar(productorEsperando);
+}
+
+void Anillo::abortar() {
+    abortado.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex);
+    cambio.notify_all();
+}
@@ -0,0 +1,69 @@
+#ifndef ANILLO_H
+#define ANILLO_H
+
+#include "entrada.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Buffer circular de bytes entre un solo productor y un solo consumidor (dos hilos). Cada lado
+// avanza su propio índice atómico, así que pasar datos no toma ningún lock. Solo cuando el anillo
+// está lleno o vacío el lado que no puede seguir gira un rato y después duerme; el otro lado lo
+// despierta, tomando el mutex únicamente si sabe que hay alguien durmiendo.
+//
+// Los dos lados trabajan sobre la memoria del anillo: el productor escribe en espacio() y
+// confirma con publicar(), el consumidor lee de datos() y devuelve el lugar con liberar().
+class Anillo {
+public:
+    // La capacidad se redondea a la potencia de 2 siguiente
+    explicit Anillo(size_t capacidad);
+
+    // Productor: lugar contiguo para escribir, esperando si el anillo está lleno. 'tamano' queda
+    // en 0 si el consumidor abortó.
+    unsigned char* espacio(size_t& tamano);
+    void publicar(size_t n);
+
+    // Productor: no hay más datos
+    void cerrar();
+
+    // Consumidor: bytes contiguos listos para leer, esperando si no hay. Un tramo vacío marca el
+    // final de los datos. Devuelve false si el productor abortó.
+    bool datos(Tramo& tramo);
+    void liberar(size_t n);
+
+    // Cualquiera de los dos lados: corta la transferencia y despierta al otro
+    void abortar();
+
+private:
+    std::vector<unsigned char> buffer;
+    size_t mascara;
+
+    // Cada índice en su propia línea de caché, junto con la copia que el dueño guarda del índice
+    // del otro lado: el índice ajeno solo se vuelve a leer cuando según la copia queda menos de
+    // medio anillo para trabajar
+    char relleno0[64];
+    std::atomic<size_t> escrito;                // Total publicado por el productor
+    size_t leidoVisto;
+    char relleno1[64];
+    std::atomic<size_t> leido;                  // Total liberado por el consumidor
+    size_t escritoVisto;
+    char relleno2[64];
+
+    std::atomic<bool> cerrado;
+    std::atomic<bool> abortado;
+    std::atomic<bool> productorEsperando;
+    std::atomic<bool> consumidorEsperando;
+    std::mutex mutex;
+    std::condition_variable cambio;
+
+    Anillo(const Anillo&);
+    Anillo& operator=(const Anillo&);
+
+    template <typename Condicion>
+    void esperar(Condicion lista, std::atomic<bool>& esperando);
+    void despertar(std::atomic<bool>& esperando);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "entrada.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t LectorEntrada::TAM_BUFFER;
+
+LectorEntrada::LectorEntrada()
+    : descriptor(-1), propio(false), mapa(nullptr), tamArchivo(0), posicion(0), liberado(0) {}
+
+LectorEntrada::~LectorEntrada() {
+    cerrar();
+}
+
+bool LectorEntrada::abrir(const std::string& ruta) {
+    cerrar();
+    propio = !esFlujoEstandar(ruta);
+    descriptor = propio ? open(ruta.c_str(), O_RDONLY) : STDIN_FILENO;
+    if (descriptor < 0) return false;
+
+    // Solo los archivos regulares no vacíos se pueden mapear
+    struct stat info;
+    if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode)) {
+        tamArchivo = static_cast<uint64_t>(info.st_size);
+        if (tamArchivo > 0) {
+            void* direccion = mmap(nullptr, tamArchivo, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            // Una entrada estándar redirigida puede no estar al principio del archivo
+            off_t actual = propio ? 0 : lseek(descriptor, 0, SEEK_CUR);
+            if (direccion != MAP_FAILED && actual >= 0 && uint64_t(actual) <= tamArchivo) {
+                mapa = static_cast<unsigned char*>(direccion);
+                posicion = static_cast<uint64_t>(actual);
+                liberado = 0;
+                madvise(mapa, tamArchivo, MADV_SEQUENTIAL);
+            } else if (direccion != MAP_FAILED) {
+                munmap(direccion, tamArchivo);
+            }
+        }
+    }
+    return true;
+}
+
+void LectorEntrada::cerrar() {
+    if (mapa) munmap(mapa, tamArchivo);
+    if (descriptor >= 0 && propio) close(descriptor);
+    descriptor = -1;
+    mapa = nullptr;
+    tamArchivo = 0;
+    posicion = 0;
+    liberado = 0;
+}
+
+// Suelta las páginas mapeadas anteriores a 'hasta' (de a TAM_BUFFER como mínimo para no llamar a
+// madvise por cada tramo chico). Si se vuelven a tocar, el kernel las trae de nuevo del archivo.
+void LectorEntrada::liberarHasta(uint64_t hasta) {
+    static const uint64_t pagina = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    hasta = hasta / pagina * pagina;
+    if (hasta >= liberado + TAM_BUFFER) {
+        madvise(mapa + liberado, hasta - liberado, MADV_DONTNEED);
+        liberado = hasta;
+    }
+}
+
+// Lee hasta 'maximo' bytes repitiendo read(): una tubería entrega los datos de a pedazos
+size_t LectorEntrada::leerDescriptor(unsigned char* destino, size_t maximo, bool& error) {
+    size_t leidos = 0;
+    error = false;
+    while (leidos < maximo) {
+        ssize_t n = read(descriptor, destino + leidos, maximo - leidos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            error = true;
+            break;
+        }
+        if (n == 0) break;
+        leidos += static_cast<size_t>(n);
+    }
+    return leidos;
+}
+
+bool LectorEntrada::leer(size_t maximo, Tramo& tramo) {
+    if (mapa) {
+        liberarHasta(posicion);
+        uint64_t restantes = tamArchivo - posicion;
+        tramo.datos = mapa + posicion;
+        tramo.tamano = static_cast<size_t>(restantes < maximo ? restantes : maximo);
+        posicion += tramo.tamano;
+        return true;
+    }
+
+    if (buffer.size() < maximo) buffer.resize(maximo);
+    bool error;
+    tramo.datos = buffer.data();
+    tramo.tamano = leerDescriptor(buffer.data(), maximo, error);
+    return !error;
+}
+
+void LectorEntrada::descartarHasta(const unsigned char* fin) {
+    if (mapa && fin >= mapa && fin <= mapa + tamArchivo) liberarHasta(static_cast<uint64_t>(fin - mapa));
+}
+
+bool LectorEntrada::leerTodo(Tramo& tramo) {
+    if (mapa) return leer(static_cast<size_t>(tamArchivo - posicion), tramo);
+
+    // Sin mapeo se acumula todo en el buffer, creciendo de a TAM_BUFFER
+    size_t total = 0;
+    bool error = false;
+    for (;;) {
+        if (buffer.size() < total + TAM_BUFFER) buffer.resize(total + TAM_BUFFER);
+        size_t leidos = leerDescriptor(buffer.data() + total, TAM_BUFFER, error);
+        total += leidos;
+        if (error || leidos < TAM_BUFFER) break;
+    }
+    tramo.datos = buffer.data();
+    tramo.tamano = total;
+    return !error;
+}
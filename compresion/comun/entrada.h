@@ -0,0 +1,67 @@
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Porción contigua de bytes de solo lectura
+struct Tramo {
+    const unsigned char* datos;
+    size_t tamano;
+};
+
+// Entrada compartida por los compresores. Los archivos regulares se mapean en memoria
+// (mmap + MADV_SEQUENTIAL) y se recorren sin copias; las tuberías y lo que no se pueda
+// mapear se leen con read() en un buffer grande. En ambos casos los códecs reciben tramos.
+class LectorEntrada {
+public:
+    static const size_t TAM_BUFFER = 1 << 20;  // Lectura por defecto con read()
+
+    LectorEntrada();
+    ~LectorEntrada();
+
+    // Nombre que los programas usan para leer de la entrada estándar y escribir a la salida estándar
+    static bool esFlujoEstandar(const std::string& ruta) { return ruta == "-"; }
+
+    // Abre un archivo por nombre, o la entrada estándar si es "-"; false (con errno) si no se pudo abrir.
+    // La entrada estándar también se mapea cuando está redirigida desde un archivo regular.
+    bool abrir(const std::string& ruta);
+    void cerrar();
+
+    // Siguiente tramo de hasta 'maximo' bytes; solo es más corto al llegar al final, y vacío
+    // cuando ya no queda nada. Mapeado, apunta al mapeo; si no, a un buffer interno que se
+    // reutiliza en la próxima llamada. Devuelve false si falla la lectura. Las páginas mapeadas
+    // de tramos anteriores se sueltan a medida que se avanza, así el RSS no crece con el archivo.
+    bool leer(size_t maximo, Tramo& tramo);
+
+    // Todo lo que queda de la entrada en un solo tramo
+    bool leerTodo(Tramo& tramo);
+
+    // Avisa que lo anterior a 'fin' (dentro de un tramo mapeado) ya no se va a usar, para soltar
+    // esas páginas cuando el tramo se recorre por partes, como el de leerTodo
+    void descartarHasta(const unsigned char* fin);
+
+    bool mapeado() const { return mapa != nullptr; }
+
+    // Tamaño del archivo si es regular (0 si no se conoce)
+    uint64_t tamano() const { return tamArchivo; }
+
+private:
+    int descriptor;
+    bool propio;                         // false para la entrada estándar, que no se cierra
+    unsigned char* mapa;
+    uint64_t tamArchivo;
+    uint64_t posicion;                   // Bytes ya entregados del mapeo
+    uint64_t liberado;                   // Inicio de las páginas del mapeo que siguen residentes
+    std::vector<unsigned char> buffer;   // Solo cuando no hay mapeo
+
+    LectorEntrada(const LectorEntrada&);             // No copiable: es dueño del descriptor y del mapeo
+    LectorEntrada& operator=(const LectorEntrada&);
+
+    size_t leerDescriptor(unsigned char* destino, size_t maximo, bool& error);
+    void liberarHasta(uint64_t hasta);
+};
+
+#endif
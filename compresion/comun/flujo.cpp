@@ -0,0 +1,36 @@
+#include "flujo.h"
+#include <vector>
+
+static const size_t TAM_SALIDA = 1 << 18;
+
+// Escribe toda la salida pendiente del códec
+static bool vaciar(codec::Stream& flujo, std::vector<unsigned char>& buffer, std::ostream& salida) {
+    size_t n;
+    while ((n = flujo.pull(buffer.data(), buffer.size())) > 0) {
+        if (!salida.write(reinterpret_cast<const char*>(buffer.data()), n)) return false;
+    }
+    return true;
+}
+
+ResultadoTransferencia transferir(LectorEntrada& entrada, codec::Stream& flujo, std::ostream& salida) {
+    std::vector<unsigned char> buffer(TAM_SALIDA);
+    for (;;) {
+        Tramo tramo;
+        bool leido = entrada.mapeado() ? entrada.leerTodo(tramo) : entrada.leer(LectorEntrada::TAM_BUFFER, tramo);
+        if (!leido) return ERROR_LECTURA;
+        if (tramo.tamano == 0) break;
+
+        // push() toma menos de lo entregado cuando tiene mucha salida pendiente: se escribe y se sigue
+        size_t usados = 0;
+        while (usados < tramo.tamano) {
+            usados += flujo.push(tramo.datos + usados, tramo.tamano - usados);
+            if (flujo.error()) return ERROR_CODEC;
+            if (!vaciar(flujo, buffer, salida)) return ERROR_ESCRITURA;
+            entrada.descartarHasta(tramo.datos + usados);
+        }
+    }
+
+    bool completo = flujo.flush();
+    if (!vaciar(flujo, buffer, salida)) return ERROR_ESCRITURA;
+    return completo ? TRANSFERENCIA_OK : ERROR_CODEC;
+}
@@ -0,0 +1,15 @@
+#ifndef FLUJO_H
+#define FLUJO_H
+
+#include "entrada.h"
+#include "../codec/codec.h"
+#include <ostream>
+
+enum ResultadoTransferencia { TRANSFERENCIA_OK, ERROR_LECTURA, ERROR_CODEC, ERROR_ESCRITURA };
+
+// Pasa toda la entrada por un códec de libcodec y escribe el resultado en 'salida'. Un archivo
+// mapeado se entrega entero y el códec lo consume por partes, sin copiarlo; las páginas ya
+// consumidas se sueltan. Con ERROR_CODEC la causa está en flujo.error().
+ResultadoTransferencia transferir(LectorEntrada& entrada, codec::Stream& flujo, std::ostream& salida);
+
+#endif
@@ -1,9 +1,11 @@
 #include <iostream>
-#include <queue>
-#include <unordered_map>
-#include <vector>
 #include <string>
 #include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include "../codec/codec.h"
+#include "../comun/entrada.h"
+#include "../comun/flujo.h"
 
 // Mostrar mensaje de ayuda
 void show_help() {
@@ -13,6 +15,10 @@ void show_help() {
     std::cout << "  -v, --version: Mostrar información sobre el autor del programa" << std::endl;
     std::cout << "  -c, --compress: Comprimir el archivo" << std::endl;
     std::cout << "  -x, --decompress: Descomprimir el archivo" << std::endl;
+    std::cout << "  -t, --threads <n>: Hilos para comprimir y descomprimir por bloques (0 = todos los núcleos)" << std::endl;
+    std::cout << "  -b, --block-size <KB>: Tamaño de los bloques al comprimir (por defecto 1024)" << std::endl;
+    std::cout << "Con '-' como archivo se lee la entrada estándar y se escribe la salida estándar," << std::endl;
+    std::cout << "por ejemplo: tar cf - dir | huffman -c - > dir.tar.huff" << std::endl;
 }
 
 // Mostrar la versión del programa
@@ -20,166 +26,114 @@ void show_version() {
     std::cout << "Compresor 1.0" << std::endl;
 }
 
-// Definición de la estructura del nodo del árbol de Huffman
-struct Nodo {
-    unsigned char caracter;
-    int frecuencia;
-    Nodo* izquierda;
-    Nodo* derecha;
-
-    Nodo(unsigned char c, int f, Nodo* izq = nullptr, Nodo* der = nullptr) 
-        : caracter(c), frecuencia(f), izquierda(izq), derecha(der) {}
-
-    ~Nodo() {
-        delete izquierda;
-        delete derecha;
-    }
-};
-
-// Comparador para la cola de prioridad, ordena por frecuencia ascendente
-struct Comparar {
-    bool operator()(Nodo* a, Nodo* b) {
-        return a->frecuencia > b->frecuencia;
+// El formato .huff y el códec están en libcodec (../codec); acá quedan los archivos y los mensajes
+
+// Pasa la entrada por el códec hacia 'salida' e informa el error si lo hay
+bool procesar(LectorEntrada& entrada, codec::Stream& flujo, std::ostream& salida,
+              const char* errorLectura, const std::string& nombreSalida) {
+    switch (transferir(entrada, flujo, salida)) {
+    case ERROR_LECTURA:
+        perror(errorLectura);
+        return false;
+    case ERROR_CODEC:
+        std::cerr << "Error: " << flujo.error() << std::endl;
+        return false;
+    case ERROR_ESCRITURA:
+        std::cerr << "Error: No se pudo escribir " << nombreSalida << std::endl;
+        return false;
+    default:
+        return true;
     }
-};
-
-// Construcción del árbol de Huffman basado en las frecuencias
-Nodo* construirArbolHuffman(const std::unordered_map<unsigned char, int>& frecuencias) {
-    std::priority_queue<Nodo*, std::vector<Nodo*>, Comparar> cola;
-    for (auto& par : frecuencias)
-        cola.push(new Nodo(par.first, par.second));
-    while (cola.size() > 1) {
-        Nodo* izquierda = cola.top(); cola.pop();
-        Nodo* derecha = cola.top(); cola.pop();
-        Nodo* padre = new Nodo('\0', izquierda->frecuencia + derecha->frecuencia, izquierda, derecha);
-        cola.push(padre);
-    }
-    return cola.top();
-}
-
-// Generación de los códigos de Huffman recorriendo el árbol
-void generarCodigos(Nodo* raiz, std::string codigo, std::unordered_map<unsigned char, std::string>& codigos) {
-    if (!raiz) return;
-    if (raiz->caracter != '\0')
-        codigos[raiz->caracter] = codigo;
-    generarCodigos(raiz->izquierda, codigo + "0", codigos);
-    generarCodigos(raiz->derecha, codigo + "1", codigos);
 }
 
-// Comprimir archivo
-void compress(const std::string& filename) {
-    std::ifstream archivoOriginal(filename, std::ios::binary);
-    if (!archivoOriginal.is_open()) {
+// Comprimir archivo; con "-" se comprime la entrada estándar hacia la salida estándar
+bool compress(const std::string& filename, unsigned hilos, size_t tamBloque) {
+    LectorEntrada archivoOriginal;
+    if (!archivoOriginal.abrir(filename)) {
         perror("Error al abrir el archivo original");
-        return;
+        return false;
     }
-    
-    // Contar las frecuencia de cada caracter
-    std::unordered_map<unsigned char, int> frecuencias;
-    char ch;
-    while (archivoOriginal.get(ch)) { // Leer el archivo caracter por caracter
-        frecuencias[static_cast<unsigned char>(ch)]++; // Incrementar la frecuencia del caracter
+    codec::EncoderPtr codificador(codec::newHuffmanEncoder(tamBloque, hilos));
+    if (!codificador) {
+        std::cerr << "Error: No hay memoria suficiente" << std::endl;
+        return false;
     }
-    archivoOriginal.clear();
-    archivoOriginal.seekg(0);
-
-    // Construir el árbol de Huffman y generar los códigos
-    Nodo* raiz = construirArbolHuffman(frecuencias);
 
-    std::unordered_map<unsigned char, std::string> codigos;
-    generarCodigos(raiz, "", codigos);
+    if (LectorEntrada::esFlujoEstandar(filename)) {
+        if (!procesar(archivoOriginal, *codificador, std::cout, "Error al leer el archivo original", "la salida estándar"))
+            return false;
+        if (!std::cout.flush()) {
+            std::cerr << "Error: No se pudo escribir la salida estándar" << std::endl;
+            return false;
+        }
+        return true;
+    }
 
     // Crear el archivo comprimido
     std::string nombreBase = filename.substr(0, filename.find_last_of(".")); // Nombre del archivo sin extensión
-    std::ofstream archivoComprimido(nombreBase+ ".huff", std::ios::binary);
-    int numCaracteresDistintos = frecuencias.size();
-    archivoComprimido.write(reinterpret_cast<const char*>(&numCaracteresDistintos), sizeof(int));
-    for (auto& par : codigos){
-        archivoComprimido.put(par.first);
-        u_int8_t longitud = par.second.size();
-        archivoComprimido.put(longitud);
-        archivoComprimido.write(par.second.data(), longitud);
-    }
+    std::string nombreComprimido = nombreBase + ".huff";
+    std::ofstream archivoComprimido(nombreComprimido, std::ios::binary);
+    bool exito = procesar(archivoOriginal, *codificador, archivoComprimido, "Error al leer el archivo original",
+                          "el archivo comprimido");
+    archivoOriginal.cerrar();
 
-    // Crear los metadatos del archivo comprimido
-    std::string bufferComprimido;
-    while (archivoOriginal.get(ch)) {
-        bufferComprimido += codigos[static_cast<unsigned char>(ch)];
+    archivoComprimido.close();
+    if (exito && !archivoComprimido) {
+        std::cerr << "Error: No se pudo escribir el archivo comprimido" << std::endl;
+        exito = false;
     }
-    archivoOriginal.close();
-
-    // Rellenar con ceros los datos faltantes para que la longitud sea múltiplo de 8
-    u_int8_t padding = 8 - (bufferComprimido.size() % 8);
-    for (int i = 0; i < padding; i++) bufferComprimido += "o";
-        archivoComprimido.put(padding);
-
-    // Escribir los datos comprimidos en el archivo
-    for (size_t i=0; i < bufferComprimido.size(); i += 8) {
-        u_int8_t byte = 0;
-        for (size_t j = 0; j < 8; j++) {
-            byte = (byte << 1) | (bufferComprimido[i + j] - '0');
-        }
-        archivoComprimido.put(byte);
+    if (!exito) {
+        std::remove(nombreComprimido.c_str());  // No dejar un archivo comprimido a medias
+        return false;
     }
-    // Liberar memoria y cerrar archivos
-    archivoComprimido.close();
-    delete raiz;
-    std::cout << "Archivo comprimido con éxito como: " << nombreBase + ".huff" << std::endl;
+    std::cout << "Archivo comprimido con éxito como: " << nombreComprimido << std::endl;
+    return true;
 }
 
-// Descomprimir archivo
-void decompress(const std::string& filename) {
-    std::ifstream archivoComprimido(filename, std::ios::binary);
-    if (!archivoComprimido.is_open()) {
+// Descomprimir archivo; con "-" se descomprime la entrada estándar hacia la salida estándar.
+// El códec reconoce la versión por la firma y descomprime la 3 a medida que llega.
+bool decompress(const std::string& filename, unsigned hilos) {
+    LectorEntrada archivoComprimido;
+    if (!archivoComprimido.abrir(filename)) {
         perror("Error al abrir el archivo comprimido");
-        return;
+        return false;
     }
-
-    // Leer los metadatos del archivo comprimido
-    int numCaracteresDistintos;
-    archivoComprimido.read(reinterpret_cast<char*>(&numCaracteresDistintos), sizeof(int));
-
-    // Leer los códigos de Huffman
-    std::unordered_map<std::string, unsigned char> codigosInversos;
-    for (int i = 0; i < numCaracteresDistintos; i++) {
-        unsigned char caracter = archivoComprimido.get();
-        u_int8_t longitud = archivoComprimido.get();
-        std::string codigo;
-        char* buffer = new char[longitud];
-        archivoComprimido.read(buffer, longitud);
-        codigo.assign(buffer, longitud);
-        delete[] buffer;
-        codigosInversos[codigo] = caracter;
+    codec::DecoderPtr decodificador(codec::newHuffmanDecoder(hilos));
+    if (!decodificador) {
+        std::cerr << "Error: No hay memoria suficiente" << std::endl;
+        return false;
     }
 
-    // Leer el padding
-    u_int8_t padding;
-    archivoComprimido.get(reinterpret_cast<char&>(padding));
-    std::string bufferBits;
-    char byte;
-    while (archivoComprimido.get(byte)) { // Leer el archivo comprimido byte por byte
-        for (int i = 7; i >= 0; i--) {
-            bufferBits += ((byte >> i) & 1) ? '1' : '0';
-        }
+    bool aSalidaEstandar = LectorEntrada::esFlujoEstandar(filename);
+    std::string outputFilename = aSalidaEstandar ? filename : filename.substr(0, filename.find_last_of("."));
+    std::ofstream archivoOriginal;
+    std::ostream& salida = aSalidaEstandar ? std::cout : archivoOriginal;
+    if (!aSalidaEstandar) archivoOriginal.open(outputFilename, std::ios::binary);
+    std::string nombreSalida = aSalidaEstandar ? "la salida estándar" : outputFilename;
+
+    bool exito = procesar(archivoComprimido, *decodificador, salida, "Error al leer el archivo comprimido", nombreSalida);
+    archivoComprimido.cerrar();
+    if (exito && !salida.flush()) {
+        std::cerr << "Error: No se pudo escribir " << nombreSalida << std::endl;
+        exito = false;
     }
-
-    archivoComprimido.close();
-    // Leer el contenido comprimido del archivo
-    bufferBits = bufferBits.substr(0, bufferBits.size() - padding); // Eliminar los bits de relleno
-    
-    std::string codigoActual;
-    std::string outputFilename = filename.substr(0, filename.find_last_of("."));
-    std::ofstream archivoOriginal(outputFilename, std::ios::binary);
-    for (char bit : bufferBits) {
-        codigoActual += bit;
-        if (codigosInversos.count(codigoActual)) {
-            archivoOriginal.put(codigosInversos[codigoActual]);
-            codigoActual.clear();
+    if (!exito) {
+        if (!aSalidaEstandar) {
+            archivoOriginal.close();
+            std::remove(outputFilename.c_str());  // Sin restos de un archivo inválido
         }
+        return false;
     }
-
-    archivoOriginal.close();
+    if (aSalidaEstandar) return true;
     std::cout << "Archivo descomprimido con éxito: " << outputFilename << std::endl;
+    return true;
+}
+
+// Lee un entero positivo de la línea de comandos
+bool leerNumero(const char* texto, long& valor) {
+    char* fin;
+    valor = strtol(texto, &fin, 10);
+    return *texto != '\0' && *fin == '\0' && valor >= 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -187,18 +141,43 @@ int main(int argc, char* argv[]) {
         show_help();
         return 1;
     }
-    std::string opcion = argv[1];
-    if (opcion == "-h" || opcion == "--help") {
-        show_help();
-    } else if (opcion == "-v" || opcion == "--version") {
-        show_version();
-    } else if (opcion == "-c" || opcion == "--compress") {
-        compress(argv[2]);
-    } else if (opcion == "-x" || opcion == "--decompress") {
-        decompress(argv[2]);
-    } else {
-        std::cerr << "Opción no reconocida. Use -h o --help para obtener ayuda." << std::endl;
+
+    std::string operacion, archivo;
+    long hilos = 0;
+    long tamBloqueKB = HUFFMAN_DEFAULT_BLOCK_SIZE / 1024;
+    for (int i = 1; i < argc; i++) {
+        std::string opcion = argv[i];
+        if (opcion == "-h" || opcion == "--help") {
+            show_help();
+            return 0;
+        } else if (opcion == "-v" || opcion == "--version") {
+            show_version();
+            return 0;
+        } else if ((opcion == "-c" || opcion == "--compress" || opcion == "-x" || opcion == "--decompress") && i + 1 < argc) {
+            operacion = opcion == "-c" || opcion == "--compress" ? "c" : "x";
+            archivo = argv[++i];
+        } else if ((opcion == "-t" || opcion == "--threads") && i + 1 < argc && leerNumero(argv[i + 1], hilos)) {
+            i++;
+        } else if ((opcion == "-b" || opcion == "--block-size") && i + 1 < argc && leerNumero(argv[i + 1], tamBloqueKB)) {
+            i++;
+        } else {
+            std::cerr << "Opción no reconocida. Use -h o --help para obtener ayuda." << std::endl;
+            return 1;
+        }
+    }
+
+    size_t tamBloque = static_cast<size_t>(tamBloqueKB) * 1024;
+    if (tamBloque < HUFFMAN_MIN_BLOCK_SIZE || tamBloque > HUFFMAN_MAX_BLOCK_SIZE) {
+        std::cerr << "Error: El tamaño de bloque debe estar entre " << HUFFMAN_MIN_BLOCK_SIZE / 1024
+                  << " y " << HUFFMAN_MAX_BLOCK_SIZE / 1024 << " KB" << std::endl;
         return 1;
     }
-    return 0;
-}
\ No newline at end of file
+    if (operacion.empty()) {
+        std::cerr << "Error: Debe indicar -c o -x con el nombre del archivo" << std::endl;
+        return 1;
+    }
+
+    unsigned numeroHilos = static_cast<unsigned>(hilos);
+    bool exito = operacion == "c" ? compress(archivo, numeroHilos, tamBloque) : decompress(archivo, numeroHilos);
+    return exito ? 0 : 1;
+}
@@ -1,10 +1,11 @@
 #include "lzw.h"
+#include "../comun/entrada.h"
+#include "../comun/flujo.h"
 #include <iostream>
 #include <fstream>
-#include <vector>
-#include <map>
-#include <cstdlib>
+#include <cstdio>
 
+// El formato y el códec están en libcodec (../codec); acá quedan los archivos y los mensajes
 
 void showHelp() {
     std::cout << "Uso: lzw [OPCIONES] [ARCHIVO]\n\n";
@@ -13,6 +14,10 @@ void showHelp() {
     std::cout << "  -v, --version                  Muestra la versión del programa\n";
     std::cout << "  -c <archivo>, --compress <archivo> Comprime el archivo especificado\n";
     std::cout << "  -x <archivo>, --decompress <archivo> Descomprime el archivo especificado\n";
+    std::cout << "  -b <bits>, --bits <bits>       Ancho máximo de los códigos al comprimir ("
+              << LZW_MIN_MAX_BITS << "-" << LZW_MAX_MAX_BITS << ", por defecto " << LZW_DEFAULT_MAX_BITS << ")\n";
+    std::cout << "\nCon '-' como archivo se lee la entrada estándar y se escribe la salida estándar:\n";
+    std::cout << "  tar cf - dir | lzw -c - > dir.tar.lzw\n";
 }
 
 void showVersion() {
@@ -20,138 +25,128 @@ void showVersion() {
 }
 
 
-bool compressFile(const std::string& filename) {
-    std::ifstream inFile(filename, std::ios::binary);
-    if (!inFile) {
-        std::cerr << "Error: No se pudo abrir el archivo: " << filename << std::endl;
+// Pasa la entrada por el códec hacia 'out' e informa el error si lo hay
+static bool runStream(LectorEntrada& input, codec::Stream& stream, std::ostream& out,
+                      const std::string& inputName, const std::string& outputName) {
+    switch (transferir(input, stream, out)) {
+    case ERROR_LECTURA:
+        std::cerr << "Error: No se pudo leer " << inputName << std::endl;
+        return false;
+    case ERROR_CODEC:
+        std::cerr << "Error: " << stream.error() << std::endl;
+        return false;
+    case ERROR_ESCRITURA:
+        std::cerr << "Error: No se pudo escribir " << outputName << std::endl;
         return false;
+    default:
+        return true;
     }
+}
 
-    std::string outputFilename = filename + ".lzw";
-    std::ofstream outFile(outputFilename, std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Error: No se pudo crear el archivo de salida: " << outputFilename << std::endl;
+bool compressFile(const std::string& filename, int maxBits) {
+    if (maxBits < LZW_MIN_MAX_BITS || maxBits > LZW_MAX_MAX_BITS) {
+        std::cerr << "Error: El ancho máximo debe estar entre " << LZW_MIN_MAX_BITS
+                  << " y " << LZW_MAX_MAX_BITS << " bits" << std::endl;
         return false;
     }
 
-    std::map<std::string, int> dictionary;
-    for (int i = 0; i < 256; i++) {
-        std::string s = "";
-        s += char(i);
-        dictionary[s] = i;
+    LectorEntrada input;
+    if (!input.abrir(filename)) {
+        std::cerr << "Error: No se pudo abrir el archivo: " << filename << std::endl;
+        return false;
     }
 
-    std::string buffer;
-    char c;
-    std::vector<int> result;
-    int nextCode = 256;
-
-    while (inFile.get(c)) {
-        std::string currentBuffer = buffer + c;
-        if (dictionary.count(currentBuffer)) {
-            buffer = currentBuffer;
-        } else {
-            result.push_back(dictionary[buffer]);
-            dictionary[currentBuffer] = nextCode++;
-            buffer = std::string(1, c);
-        }
+    codec::EncoderPtr encoder(codec::newLzwEncoder(maxBits));
+    if (!encoder) {
+        std::cerr << "Error: No hay memoria suficiente" << std::endl;
+        return false;
     }
 
-
-    if (!buffer.empty()) {
-        result.push_back(dictionary[buffer]);
+    // Modo tubería: de la entrada estándar a la salida estándar, sin mensajes en stdout
+    if (LectorEntrada::esFlujoEstandar(filename)) {
+        if (!runStream(input, *encoder, std::cout, "la entrada estándar", "la salida estándar")) return false;
+        if (!std::cout.flush()) {
+            std::cerr << "Error: No se pudo escribir la salida estándar" << std::endl;
+            return false;
+        }
+        return true;
     }
 
-
-    int resultSize = result.size();
-    outFile.write(reinterpret_cast<const char*>(&resultSize), sizeof(resultSize));
-
-
-    for (int code : result) {
-        outFile.write(reinterpret_cast<const char*>(&code), sizeof(code));
+    std::string outputFilename = filename + ".lzw";
+    std::ofstream outFile(outputFilename, std::ios::binary);
+    if (!outFile) {
+        std::cerr << "Error: No se pudo crear el archivo de salida: " << outputFilename << std::endl;
+        return false;
     }
 
-    inFile.close();
+    bool ok = runStream(input, *encoder, outFile, "el archivo: " + filename,
+                        "el archivo de salida: " + outputFilename);
     outFile.close();
+    if (ok && !outFile) {
+        std::cerr << "Error: No se pudo escribir el archivo de salida: " << outputFilename << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        std::remove(outputFilename.c_str());  // No dejar un archivo comprimido a medias
+        return false;
+    }
 
     std::cout << "Archivo comprimido exitosamente como: " << outputFilename << std::endl;
     return true;
 }
 
-
 bool decompressFile(const std::string& filename) {
-    std::ifstream inFile(filename, std::ios::binary);
-    if (!inFile) {
+    LectorEntrada inFile;
+    if (!inFile.abrir(filename)) {
         std::cerr << "Error: No se pudo abrir el archivo: " << filename << std::endl;
         return false;
     }
 
 
-    if (filename.length() < 4 || filename.substr(filename.length() - 4) != ".lzw") {
+    bool toStdout = LectorEntrada::esFlujoEstandar(filename);
+    if (!toStdout && (filename.length() < 4 || filename.substr(filename.length() - 4) != ".lzw")) {
         std::cerr << "Error: El archivo no tiene la extensión .lzw" << std::endl;
         return false;
     }
 
-    std::string outputFilename = filename.substr(0, filename.length() - 4);
-    std::ofstream outFile(outputFilename, std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Error: No se pudo crear el archivo de salida: " << outputFilename << std::endl;
+    codec::DecoderPtr decoder(codec::newLzwDecoder());
+    if (!decoder) {
+        std::cerr << "Error: No hay memoria suficiente" << std::endl;
         return false;
     }
 
-
-    int resultSize;
-    inFile.read(reinterpret_cast<char*>(&resultSize), sizeof(resultSize));
-
-    std::vector<int> compressed;
-    for (int i = 0; i < resultSize; i++) {
-        int code;
-        inFile.read(reinterpret_cast<char*>(&code), sizeof(code));
-        compressed.push_back(code);
-    }
-
-    std::map<int, std::string> dictionary;
-    for (int i = 0; i < 256; i++) {
-        dictionary[i] = std::string(1, char(i));
+    // Con "-" se escribe a la salida estándar; si no, al nombre sin la extensión .lzw
+    std::string outputFilename = toStdout ? filename : filename.substr(0, filename.length() - 4);
+    std::ofstream outFile;
+    std::ostream* out = &std::cout;
+    if (!toStdout) {
+        outFile.open(outputFilename, std::ios::binary);
+        if (!outFile) {
+            std::cerr << "Error: No se pudo crear el archivo de salida: " << outputFilename << std::endl;
+            return false;
+        }
+        out = &outFile;
     }
 
+    bool ok = runStream(inFile, *decoder, *out, toStdout ? "la entrada estándar" : "el archivo: " + filename,
+                        toStdout ? "la salida estándar" : "el archivo de salida: " + outputFilename);
 
-    std::string entry;
-    int nextCode = 256;
-    
-    if (compressed.empty()) {
-        inFile.close();
+    inFile.cerrar();
+    if (toStdout) {
+        out->flush();
+    } else {
         outFile.close();
-        std::cout << "Archivo descomprimido exitosamente como: " << outputFilename << std::endl;
-        return true;
     }
-
-    std::string result = dictionary[compressed[0]];
-    outFile.write(result.c_str(), result.length());
-    
-    for (size_t i = 1; i < compressed.size(); i++) {
-        int code = compressed[i];
-        
-        if (dictionary.count(code)) {
-            entry = dictionary[code];
-        } else if (code == nextCode) {
-            entry = result + result[0];
-        } else {
-            std::cerr << "Error: Código inválido encontrado durante la descompresión" << std::endl;
-            inFile.close();
-            outFile.close();
-            return false;
-        }
-        
-        outFile.write(entry.c_str(), entry.length());
-        
-        dictionary[nextCode++] = result + entry[0];
-        result = entry;
+    if (ok && !*out) {
+        std::cerr << "Error: No se pudo escribir el archivo de salida: " << outputFilename << std::endl;
+        ok = false;
     }
-
-    inFile.close();
-    outFile.close();
+    if (!ok) {
+        if (!toStdout) std::remove(outputFilename.c_str());  // Sin restos de un archivo inválido
+        return false;
+    }
+    if (toStdout) return true;
 
     std::cout << "Archivo descomprimido exitosamente como: " << outputFilename << std::endl;
     return true;
-}
\ No newline at end of file
+}
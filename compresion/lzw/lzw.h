@@ -2,15 +2,16 @@
 #define LZW_H
 
 #include <string>
+#include "../codec/codec.h"
 
 
-#define VERSION "1.0.0"
+#define VERSION "2.0.0"
 
 void showHelp();
 void showVersion();
 
 
-bool compressFile(const std::string& filename);
+bool compressFile(const std::string& filename, int maxBits = LZW_DEFAULT_MAX_BITS);
 bool decompressFile(const std::string& filename);
 
 #endif 
\ No newline at end of file
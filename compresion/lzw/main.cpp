@@ -1,6 +1,7 @@
 #include "lzw.h"
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 
 int main(int argc, char* argv[]) {
 
@@ -11,6 +12,7 @@ int main(int argc, char* argv[]) {
 
     bool compress = false, decompress = false;
     std::string filename;
+    int maxBits = LZW_DEFAULT_MAX_BITS;
 
 
     for (int i = 1; i < argc; i++) {
@@ -38,6 +40,14 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Falta el nombre del archivo para la descompresión" << std::endl;
                 return 1;
             }
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--bits") == 0) {
+            if (i + 1 < argc) {
+                maxBits = atoi(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: Falta el ancho máximo de los códigos" << std::endl;
+                return 1;
+            }
         } else {
             std::cerr << "Error: Opción desconocida: " << argv[i] << std::endl;
             std::cerr << "Use --help para obtener información de uso" << std::endl;
@@ -56,7 +66,7 @@ int main(int argc, char* argv[]) {
     }
 
     if (compress) {
-        if (!compressFile(filename)) {
+        if (!compressFile(filename, maxBits)) {
             return 1;
         }
     } else if (decompress) {